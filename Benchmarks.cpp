@@ -0,0 +1,418 @@
+#include "ByteStreams.h"
+#include "Serialize.h"
+#include "Deserialize.h"
+#include "SharedOutByteStream.h"
+#include "SerializationCache.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+
+// Every heap allocation made by the program is counted, benchmarks read the difference.
+// All forms of operator new and delete are replaced so each allocation is paired with the matching free.
+static std::atomic<std::size_t> allocationCount = 0;
+
+static void* countedAllocate(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+static void* countedAllocate(std::size_t size, std::align_val_t alignment) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    const std::size_t align = static_cast<std::size_t>(alignment);
+    // aligned_alloc needs a size that is a multiple of the alignment
+    const std::size_t rounded = (std::max<std::size_t>(size, 1) + align - 1) / align * align;
+#ifdef _MSC_VER
+    // MSVC has no aligned_alloc, its aligned blocks must be released with _aligned_free
+    void* ptr = _aligned_malloc(rounded, align);
+#else
+    void* ptr = std::aligned_alloc(align, rounded);
+#endif
+    if (ptr) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+static void countedFree(void* ptr) noexcept {
+    std::free(ptr);
+}
+static void countedAlignedFree(void* ptr) noexcept {
+#ifdef _MSC_VER
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+void* operator new(std::size_t size) {
+    return countedAllocate(size);
+}
+void* operator new[](std::size_t size) {
+    return countedAllocate(size);
+}
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return countedAllocate(size, alignment);
+}
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return countedAllocate(size, alignment);
+}
+void operator delete(void* ptr) noexcept {
+    countedFree(ptr);
+}
+void operator delete[](void* ptr) noexcept {
+    countedFree(ptr);
+}
+void operator delete(void* ptr, std::size_t) noexcept {
+    countedFree(ptr);
+}
+void operator delete[](void* ptr, std::size_t) noexcept {
+    countedFree(ptr);
+}
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    countedAlignedFree(ptr);
+}
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+    countedAlignedFree(ptr);
+}
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept {
+    countedAlignedFree(ptr);
+}
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept {
+    countedAlignedFree(ptr);
+}
+
+using Clock = std::chrono::steady_clock;
+
+// Amount of encoded data each benchmark processes, the iteration count is derived from it
+constexpr const std::size_t TARGET_BYTES = 64 * 1024 * 1024;
+constexpr const std::size_t MAX_ITERATIONS = 200'000;
+
+// Results are accumulated here so the compiler cannot drop the decoded values
+static std::size_t sink = 0;
+
+struct BenchmarkResult {
+    std::string name;
+    std::string path;
+    std::size_t iterations = 0;
+    std::size_t bytesPerOp = 0;
+    double encodeSeconds = 0;
+    double decodeSeconds = 0;
+    std::size_t encodeAllocations = 0;
+    std::size_t decodeAllocations = 0;
+};
+
+class BenchRecord {
+    int32_t id;
+    double score;
+    std::string label;
+    std::vector<int32_t> tags;
+public:
+    explicit BenchRecord(int32_t id) noexcept : id{ id }, score{ id * 0.5 }, label{ "record-" + std::to_string(id) }, tags{ id, id + 1, id + 2 } {}
+    // This is the deserialization constructor
+    explicit BenchRecord(InByteStream& ibs) {
+        id = deserialize<int32_t>(ibs);
+        score = deserialize<double>(ibs);
+        label = deserialize<std::string>(ibs);
+        tags = deserialize<std::vector<int32_t>>(ibs);
+    }
+    static void serialize(const BenchRecord& br, OutByteStream& obs) noexcept {
+        ::serialize(br.id, obs);
+        ::serialize(br.score, obs);
+        ::serialize(br.label, obs);
+        ::serialize(br.tags, obs);
+    }
+    std::size_t size() const noexcept {
+        return label.size();
+    }
+};
+
+// An immutable value that is expensive to encode, the version identifies its content
+class BenchConfig {
+    uint64_t version;
+    std::map<std::string, std::vector<int32_t>> settings;
+public:
+    explicit BenchConfig(uint64_t version) : version{ version } {
+        for (int32_t i = 0; i < 64; i++) {
+            settings.insert({ "setting-" + std::to_string(i), std::vector<int32_t>(16, i) });
+        }
+    }
+    // This is the deserialization constructor
+    explicit BenchConfig(InByteStream& ibs) {
+        version = deserialize<uint64_t>(ibs);
+        settings = deserialize<std::map<std::string, std::vector<int32_t>>>(ibs);
+    }
+    static void serialize(const BenchConfig& bc, OutByteStream& obs) noexcept {
+        ::serialize(bc.version, obs);
+        ::serialize(bc.settings, obs);
+    }
+    static uint64_t cacheKey(const BenchConfig& bc) noexcept {
+        return bc.version;
+    }
+    std::size_t size() const noexcept {
+        return settings.size();
+    }
+};
+
+template<typename T> std::size_t touch(const T& value) {
+    if constexpr (Arithmetic<T>) {
+        return static_cast<std::size_t>(value);
+    }
+    else {
+        return value.size();
+    }
+}
+
+template<typename T> std::size_t encodedSize(const T& value) {
+    OutByteStream obs = OutByteStream();
+    serialize(value, obs);
+    return obs.buffer().size();
+}
+
+std::size_t iterationsFor(std::size_t bytesPerOp) {
+    const std::size_t iterations = TARGET_BYTES / (bytesPerOp == 0 ? 1 : bytesPerOp);
+    return std::min(std::max<std::size_t>(iterations, 1), MAX_ITERATIONS);
+}
+
+template<typename T> BenchmarkResult benchmarkMemory(const std::string& name, const T& value) {
+    BenchmarkResult result;
+    result.name = name;
+    result.path = "memory";
+    result.bytesPerOp = encodedSize(value);
+    result.iterations = iterationsFor(result.bytesPerOp);
+
+    Clock::duration encodeTime = {};
+    Clock::duration decodeTime = {};
+    for (std::size_t i = 0; i < result.iterations; i++) {
+        const std::size_t encodeAllocations = allocationCount;
+        const auto encodeStart = Clock::now();
+        OutByteStream obs = OutByteStream();
+        serialize(value, obs);
+        encodeTime += Clock::now() - encodeStart;
+        result.encodeAllocations += allocationCount - encodeAllocations;
+
+        // The InByteStream takes ownership of the encoded bytes
+        const std::size_t decodeAllocations = allocationCount;
+        const auto decodeStart = Clock::now();
+        InByteStream ibs = InByteStream(obs);
+        sink += touch(deserialize<T>(ibs));
+        decodeTime += Clock::now() - decodeStart;
+        result.decodeAllocations += allocationCount - decodeAllocations;
+    }
+    result.encodeSeconds = std::chrono::duration<double>(encodeTime).count();
+    result.decodeSeconds = std::chrono::duration<double>(decodeTime).count();
+    return result;
+}
+
+template<typename T> BenchmarkResult benchmarkFile(const std::string& name, const T& value, const std::optional<ReadAhead>& readAhead = std::nullopt) {
+    const std::string path = "./benchmark.bin";
+
+    BenchmarkResult result;
+    result.name = name;
+    result.path = readAhead ? "file+readahead" : "file";
+    result.bytesPerOp = encodedSize(value);
+    // The file path is much slower per op, a tenth of the data keeps the run short
+    result.iterations = std::max<std::size_t>(iterationsFor(result.bytesPerOp) / 10, 1);
+
+    Clock::duration encodeTime = {};
+    Clock::duration decodeTime = {};
+    for (std::size_t i = 0; i < result.iterations; i++) {
+        const std::size_t encodeAllocations = allocationCount;
+        const auto encodeStart = Clock::now();
+        {
+            OutByteStream obs = OutByteStream(path);
+            serialize(value, obs);
+            obs.writeToFile();
+        }
+        encodeTime += Clock::now() - encodeStart;
+        result.encodeAllocations += allocationCount - encodeAllocations;
+
+        const std::size_t decodeAllocations = allocationCount;
+        const auto decodeStart = Clock::now();
+        {
+            InByteStream ibs = readAhead ? InByteStream(path, *readAhead) : InByteStream(path);
+            sink += touch(deserialize<T>(ibs));
+        }
+        decodeTime += Clock::now() - decodeStart;
+        result.decodeAllocations += allocationCount - decodeAllocations;
+    }
+    result.encodeSeconds = std::chrono::duration<double>(encodeTime).count();
+    result.decodeSeconds = std::chrono::duration<double>(decodeTime).count();
+    std::filesystem::remove(path);
+    return result;
+}
+
+template<typename T> void benchmark(std::vector<BenchmarkResult>& results, const std::string& name, const T& value) {
+    results.push_back(benchmarkMemory(name, value));
+    results.push_back(benchmarkFile(name, value));
+    results.push_back(benchmarkFile(name, value, ReadAhead{}));
+}
+
+// Many threads appending records to one file, only the encode side is measured
+BenchmarkResult benchmarkShared(std::size_t threadCount, const std::vector<BenchRecord>& records) {
+    const std::string path = "./benchmark.bin";
+
+    BenchmarkResult result;
+    result.name = "SharedOutByteStream/" + std::to_string(threadCount) + " threads";
+    result.path = "file";
+    result.iterations = 1;
+    result.bytesPerOp = encodedSize(records) * threadCount;
+
+    const std::size_t encodeAllocations = allocationCount;
+    const auto encodeStart = Clock::now();
+    {
+        SharedOutByteStream shared = SharedOutByteStream(path);
+        std::vector<std::thread> threads;
+        for (std::size_t t = 0; t < threadCount; t++) {
+            threads.emplace_back([&shared, &records]() {
+                SharedOutByteStream::Writer writer = shared.writer();
+                for (const BenchRecord& record : records) {
+                    writer.write(record);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+    result.encodeSeconds = std::chrono::duration<double>(Clock::now() - encodeStart).count();
+    result.encodeAllocations = allocationCount - encodeAllocations;
+    std::filesystem::remove(path);
+    return result;
+}
+
+// The same value encoded again through a SerializationCache, the first iteration fills it.
+// Only the encode side is measured.
+template<typename T> BenchmarkResult benchmarkCached(const std::string& name, const T& value) {
+    SerializationCache cache = SerializationCache(64 * 1024 * 1024);
+
+    BenchmarkResult result;
+    result.name = name;
+    result.path = "memory+cache";
+    result.bytesPerOp = encodedSize(value);
+    result.iterations = iterationsFor(result.bytesPerOp);
+
+    Clock::duration encodeTime = {};
+    for (std::size_t i = 0; i < result.iterations; i++) {
+        const std::size_t encodeAllocations = allocationCount;
+        const auto encodeStart = Clock::now();
+        OutByteStream obs = OutByteStream();
+        obs.setCache(&cache);
+        serialize(value, obs);
+        encodeTime += Clock::now() - encodeStart;
+        result.encodeAllocations += allocationCount - encodeAllocations;
+        sink += obs.buffer().size();
+    }
+    result.encodeSeconds = std::chrono::duration<double>(encodeTime).count();
+    return result;
+}
+
+double megabytesPerSecond(std::size_t bytes, double seconds) {
+    return seconds > 0 ? (static_cast<double>(bytes) / (1024.0 * 1024.0)) / seconds : 0;
+}
+
+std::string toJson(const std::vector<BenchmarkResult>& results) {
+    std::ostringstream out;
+    out << "{\n  \"benchmarks\": [\n";
+    for (std::size_t i = 0; i < results.size(); i++) {
+        const BenchmarkResult& r = results[i];
+        const std::size_t totalBytes = r.bytesPerOp * r.iterations;
+        const double iterations = static_cast<double>(r.iterations);
+        out << "    {"
+            << "\"name\": \"" << r.name << "\", "
+            << "\"path\": \"" << r.path << "\", "
+            << "\"iterations\": " << r.iterations << ", "
+            << "\"bytes_per_op\": " << r.bytesPerOp << ", "
+            << "\"encode_mb_per_s\": " << megabytesPerSecond(totalBytes, r.encodeSeconds) << ", "
+            << "\"decode_mb_per_s\": " << megabytesPerSecond(totalBytes, r.decodeSeconds) << ", "
+            << "\"encode_ns_per_op\": " << r.encodeSeconds * 1e9 / iterations << ", "
+            << "\"decode_ns_per_op\": " << r.decodeSeconds * 1e9 / iterations << ", "
+            << "\"encode_allocs_per_op\": " << static_cast<double>(r.encodeAllocations) / iterations << ", "
+            << "\"decode_allocs_per_op\": " << static_cast<double>(r.decodeAllocations) / iterations
+            << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+    return out.str();
+}
+
+// Usage: BinarySerializerBenchmarks [output.json]
+int main(int argc, char** argv) {
+    constexpr const int32_t count = 100'000;
+
+    std::vector<int32_t> ints;
+    std::vector<double> doubles;
+    std::vector<std::string> strings;
+    std::set<int32_t> intSet;
+    std::unordered_set<int32_t> intUnorderedSet;
+    std::map<int32_t, double> intMap;
+    std::unordered_map<std::string, int32_t> stringUnorderedMap;
+    std::vector<BenchRecord> records;
+    std::map<std::string, std::vector<int32_t>> nested;
+    std::vector<std::array<float, 16>> matrices;
+    std::vector<std::tuple<int32_t, double, uint8_t>> tuples;
+    std::vector<std::variant<int32_t, std::string>> variants;
+    std::vector<bool> flags;
+    // Messages referencing a handful of shared configs
+    std::vector<BenchConfig> configs;
+    for (uint64_t i = 0; i < 256; i++) {
+        configs.push_back(BenchConfig(i % 8));
+    }
+    for (int32_t i = 0; i < count; i++) {
+        ints.push_back(i);
+        doubles.push_back(i * 0.25);
+        strings.push_back("value-" + std::to_string(i));
+        intSet.insert(i);
+        intUnorderedSet.insert(i);
+        intMap.insert({ i, i * 0.5 });
+        stringUnorderedMap.insert({ "key-" + std::to_string(i), i });
+        records.push_back(BenchRecord(i));
+        matrices.push_back(std::array<float, 16>{ static_cast<float>(i) });
+        tuples.push_back({ i, i * 0.5, static_cast<uint8_t>(i) });
+        flags.push_back(i % 3 == 0);
+        variants.push_back(i % 2 == 0 ? std::variant<int32_t, std::string>(i) : std::variant<int32_t, std::string>(std::to_string(i)));
+        if (i % 100 == 0) {
+            nested.insert({ "bucket-" + std::to_string(i), std::vector<int32_t>(100, i) });
+        }
+    }
+
+    std::vector<BenchmarkResult> results;
+    benchmark(results, "uint8_t", uint8_t{ 7 });
+    benchmark(results, "int32_t", int32_t{ 123456 });
+    benchmark(results, "double", 3.14159);
+    benchmark(results, "std::string", std::string(1024, 'x'));
+    benchmark(results, "std::vector<int32_t>", ints);
+    benchmark(results, "std::vector<double>", doubles);
+    benchmark(results, "std::vector<std::string>", strings);
+    benchmark(results, "std::set<int32_t>", intSet);
+    benchmark(results, "std::unordered_set<int32_t>", intUnorderedSet);
+    benchmark(results, "std::map<int32_t, double>", intMap);
+    benchmark(results, "std::unordered_map<std::string, int32_t>", stringUnorderedMap);
+    benchmark(results, "Serializable", BenchRecord(42));
+    benchmark(results, "std::vector<Serializable>", records);
+    results.push_back(benchmarkMemory("std::vector<Cacheable>", configs));
+    results.push_back(benchmarkCached("std::vector<Cacheable>", configs));
+    benchmark(results, "std::map<std::string, std::vector<int32_t>>", nested);
+    benchmark(results, "std::vector<std::array<float, 16>>", matrices);
+    benchmark(results, "std::vector<std::tuple<int32_t, double, uint8_t>>", tuples);
+    benchmark(results, "std::vector<bool>", flags);
+    benchmark(results, "std::vector<std::variant<int32_t, std::string>>", variants);
+    for (std::size_t threadCount = 1; threadCount <= std::max(1u, std::thread::hardware_concurrency()); threadCount *= 2) {
+        results.push_back(benchmarkShared(threadCount, records));
+    }
+
+    const std::string json = toJson(results);
+    if (argc > 1) {
+        std::ofstream out(argv[1]);
+        out << json;
+    }
+    else {
+        std::cout << json;
+    }
+    std::cerr << "sink " << sink << "\n";
+    return 0;
+}
@@ -9,12 +9,30 @@
 #include <unordered_set>
 #include <map>
 #include <unordered_map>
+#include <memory>
+#include <array>
+#include <tuple>
+#include <optional>
+#include <variant>
+#include <bitset>
+#include <span>
 
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <chrono>
+#include <functional>
+#include <typeindex>
+#include <utility>
 #include <filesystem>
 #include <cassert>
 #include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 class OutByteStream;
+class SerializationCache;
 class InByteStream;
 
 template<typename T> concept isVector = std::same_as<T, std::vector<typename T::value_type, typename T::allocator_type>>;
@@ -28,9 +46,42 @@ template<typename T> concept isMap =
     std::same_as<T, std::map<typename T::key_type, typename T::mapped_type, typename T::key_compare, typename T::allocator_type>> ||
     std::same_as<T, std::unordered_map<typename T::key_type, typename T::mapped_type, typename T::hasher, typename T::key_equal, typename T::allocator_type>>;
 
+template<typename T> concept isSharedPtr = std::same_as<T, std::shared_ptr<typename T::element_type>>;
+
+template<typename T> concept isUniquePtr = std::same_as<T, std::unique_ptr<typename T::element_type>>;
+
+template<typename T> concept isPair = std::same_as<T, std::pair<typename T::first_type, typename T::second_type>>;
+
+template<typename T> concept isOptional = std::same_as<T, std::optional<typename T::value_type>>;
+
+// std::array, std::tuple and std::variant have no member types naming all of their template arguments
+template<typename T> struct IsArrayTrait : std::false_type {};
+template<typename T, std::size_t N> struct IsArrayTrait<std::array<T, N>> : std::true_type {};
+template<typename T> struct IsTupleTrait : std::false_type {};
+template<typename... Ts> struct IsTupleTrait<std::tuple<Ts...>> : std::true_type {};
+template<typename T> struct IsVariantTrait : std::false_type {};
+template<typename... Ts> struct IsVariantTrait<std::variant<Ts...>> : std::true_type {};
+template<typename T> struct IsBitsetTrait : std::false_type {};
+template<std::size_t N> struct IsBitsetTrait<std::bitset<N>> : std::true_type {};
+
+template<typename T> concept isArray = IsArrayTrait<T>::value;
+
+template<typename T> concept isTuple = IsTupleTrait<T>::value;
+
+template<typename T> concept isVariant = IsVariantTrait<T>::value;
+
+template<typename T> concept isBitset = IsBitsetTrait<T>::value;
+
+// The index of a variant is written as a single byte unless it has 256 alternatives or more,
+// the largest value of the index type is left for a valueless variant
+template<typename T> using VariantIndex = std::conditional_t<(std::variant_size_v<T> < 256), uint8_t, uint32_t>;
+
 // Works for ints, floats, bool
 template<class T> concept Arithmetic = std::is_arithmetic<T>::value;
 
+// Arrays of arithmetic types are stored exactly as they are serialized
+template<typename T> concept isArithmeticArray = isArray<T> && Arithmetic<typename T::value_type>;
+
 // Check if a type can be serialized (has method .serialize() -> )
 template<class T> concept Serializable = requires (T object, OutByteStream & obsType) {
     {T::serialize(object, obsType)} -> std::same_as<void>;
@@ -41,91 +92,818 @@ template<class T> concept Deserializable = requires (T object, InByteStream & ib
     {T(ibsType)} -> std::same_as<T>;
 };
 
+// Check if a type can skip over its own serialized form (has static method skip())
+template<class T> concept Skippable = requires (InByteStream & ibsType) {
+    {T::skip(ibsType)} -> std::same_as<void>;
+};
+
+// Opt-in for user types: the payload is prefixed with its length in bytes so it can be skipped with a single seek
+template<class T> concept LengthPrefixed = requires {
+    requires bool(T::lengthPrefixed);
+};
+
+// Opt-in for immutable user types: static uint64_t T::cacheKey(const T&) returns a content or identity hash,
+// the encoding is then memoized by the SerializationCache attached to the stream
+template<class T> concept Cacheable = requires (const T& object) {
+    {T::cacheKey(object)} -> std::convertible_to<uint64_t>;
+};
+
+// Number of bytes a type always serializes to, 0 if it is not fixed
+template<typename T> constexpr std::size_t fixedSerializedSize = 0;
+template<typename T> requires Arithmetic<T> constexpr std::size_t fixedSerializedSize<T> = sizeof(T);
+
+template<class T> concept FixedSize = fixedSerializedSize<T> != 0;
+
+// Arrays, pairs and tuples are fixed when all of their elements are, they are written without a length prefix
+template<typename T, std::size_t N> constexpr std::size_t fixedSerializedSize<std::array<T, N>> =
+    FixedSize<T> ? N * fixedSerializedSize<T> : 0;
+template<typename T, typename U> constexpr std::size_t fixedSerializedSize<std::pair<T, U>> =
+    (FixedSize<T> && FixedSize<U>) ? fixedSerializedSize<T> + fixedSerializedSize<U> : 0;
+template<typename... Ts> constexpr std::size_t fixedSerializedSize<std::tuple<Ts...>> =
+    (FixedSize<Ts> && ...) ? (std::size_t{ 0 } + ... + fixedSerializedSize<Ts>) : 0;
+
+// std::vector<bool> and std::bitset are packed into 64 bit words, bit i is bit i % 64 of word i / 64
+constexpr const std::size_t BITS_PER_WORD = 64;
+constexpr std::size_t packedWordCount(std::size_t bits) noexcept {
+    return (bits + BITS_PER_WORD - 1) / BITS_PER_WORD;
+}
+template<std::size_t N> constexpr std::size_t fixedSerializedSize<std::bitset<N>> = packedWordCount(N) * sizeof(uint64_t);
+
+// Offset of element I of a fixed pair or tuple
+template<typename T, std::size_t... J> constexpr std::size_t fixedElementsSize(std::index_sequence<J...>) {
+    return (std::size_t{ 0 } + ... + fixedSerializedSize<std::tuple_element_t<J, T>>);
+}
+template<typename T, std::size_t I> constexpr std::size_t fixedElementOffset = fixedElementsSize<T>(std::make_index_sequence<I>{});
+
+// Fewest bytes a value of the type can serialize to, used to reject lengths larger than the remaining input
+template<typename T> constexpr std::size_t minSerializedSize = fixedSerializedSize<T>;
+template<typename T> requires isVector<T> || isSet<T> || isMap<T> || isSharedPtr<T> || LengthPrefixed<T> || std::same_as<T, std::string>
+constexpr std::size_t minSerializedSize<T> = sizeof(std::size_t);
+template<typename T> requires isUniquePtr<T> || isOptional<T> constexpr std::size_t minSerializedSize<T> = sizeof(bool);
+template<typename T> requires isVariant<T> constexpr std::size_t minSerializedSize<T> = sizeof(VariantIndex<T>);
+template<typename T, std::size_t N> constexpr std::size_t minSerializedSize<std::array<T, N>> = N * minSerializedSize<T>;
+template<typename T, typename U> constexpr std::size_t minSerializedSize<std::pair<T, U>> = minSerializedSize<T> + minSerializedSize<U>;
+template<typename... Ts> constexpr std::size_t minSerializedSize<std::tuple<Ts...>> = (std::size_t{ 0 } + ... + minSerializedSize<Ts>);
+
 constexpr const uint8_t BITS_PER_BYTE = 8;
 constexpr const uint8_t BOTTOM_BYTE_MASK = 0xFF;
 constexpr const std::size_t BUFFER_REFILL_SIZE = 4096;
+// Largest fixed size value that is assembled on the stack and copied to or from a stream at once
+constexpr const std::size_t FIXED_BUFFER_SIZE = 256;
+
+// Define BINARYSERIALIZER_DISABLE_STATS to compile out the stream counters
+#ifdef BINARYSERIALIZER_DISABLE_STATS
+constexpr const bool STREAM_STATS_ENABLED = false;
+#else
+constexpr const bool STREAM_STATS_ENABLED = true;
+#endif
+
+// Snapshot of the counters of a byte stream
+struct StreamStats {
+    std::size_t bytes = 0;          // Bytes pushed into an OutByteStream / consumed from an InByteStream
+    std::size_t flushes = 0;        // Buffer writes to the file (OutByteStream)
+    std::size_t refills = 0;        // Buffer reads from the file (InByteStream)
+    std::size_t ioCalls = 0;        // Read, write and seek calls on the file stream, not system calls: the filebuf may buffer or split them
+    std::chrono::nanoseconds ioTime = {}; // Time spent blocked in file I/O
+    std::size_t largestValue = 0;   // Most bytes moved by a single push, read or skip call
+};
+
+// Called after every flush (OutByteStream) or refill (InByteStream), never called when the stats are compiled out
+using StreamStatsHook = std::function<void(const StreamStats&)>;
+
+enum class DecodeError {
+    None,
+    UnexpectedEnd,      // Read past the end of the input
+    LengthExceedsInput, // A length prefix needs more bytes than there are left in the input
+    TooManyElements,    // A length prefix is larger than DecodeLimits::maxElements
+    TooManyBytes,       // Decoding would consume more than DecodeLimits::maxBytes
+    TooDeep,            // Containers are nested deeper than DecodeLimits::maxDepth
+    InvalidReference,   // A shared_ptr refers to an object that has not been decoded or has another type
+    InvalidVariantIndex, // A variant index is not one of its alternatives
+    InvalidDeltaRecord, // A delta record has an unknown operation
+    InvalidCompressedData, // A compressed payload does not decode to its element count
+    LengthMismatch,     // A length prefixed payload decodes past its length
+};
+
+// Resource limits for an InByteStream, checked before anything is allocated
+struct DecodeLimits {
+    std::size_t maxElements = SIZE_MAX; // Largest length prefix of a single container or string
+    std::size_t maxBytes = SIZE_MAX;    // Most bytes consumed from the stream
+    std::size_t maxDepth = SIZE_MAX;    // Deepest nesting of containers
+};
+
+// Mask of the bits of the last word that hold one of count bits
+constexpr uint64_t lastWordMask(std::size_t count) noexcept {
+    return count % BITS_PER_WORD == 0 ? ~uint64_t{ 0 } : (uint64_t{ 1 } << (count % BITS_PER_WORD)) - 1;
+}
+// The storage words of a vector<bool> when the standard library is known to lay them out like the encoding,
+// nullptr otherwise. This is the only place that depends on the library: libstdc++ exposes its words through
+// an implementation detail of the iterator, every other library takes the portable per bit loops below.
+template<typename V> requires std::same_as<std::remove_const_t<V>, std::vector<bool>> auto vectorBoolWords(V& data) noexcept {
+    using Word = std::conditional_t<std::is_const_v<V>, const uint64_t, uint64_t>;
+#ifdef __GLIBCXX__
+    if constexpr (sizeof(std::_Bit_type) == sizeof(uint64_t) && std::endian::native == std::endian::little) {
+        return reinterpret_cast<Word*>(data.begin()._M_p);
+    }
+#endif
+    return static_cast<Word*>(nullptr);
+}
+// Packs a vector<bool> into packedWordCount(data.size()) words, the unused bits of the last word are zero
+constexpr void packBits(const std::vector<bool>& data, uint64_t* words) noexcept {
+    const std::size_t wordCount = packedWordCount(data.size());
+    if (wordCount == 0) {
+        return;
+    }
+    // Constant evaluation cannot read the storage words, the bits are packed one at a time
+    if (!std::is_constant_evaluated()) {
+        if (const uint64_t* storage = vectorBoolWords(data)) {
+            std::memcpy(words, storage, wordCount * sizeof(uint64_t));
+            words[wordCount - 1] &= lastWordMask(data.size());
+            return;
+        }
+    }
+    for (std::size_t w = 0; w < wordCount; w++) {
+        const std::size_t first = w * BITS_PER_WORD;
+        const std::size_t count = std::min(BITS_PER_WORD, data.size() - first);
+        uint64_t word = 0;
+        for (std::size_t j = 0; j < count; j++) {
+            word |= static_cast<uint64_t>(data[first + j]) << j;
+        }
+        words[w] = word;
+    }
+}
+// Unpacks words into a vector<bool> that already has its final size
+inline void unpackBits(const uint64_t* words, std::vector<bool>& data) noexcept {
+    const std::size_t wordCount = packedWordCount(data.size());
+    if (wordCount == 0) {
+        return;
+    }
+    if (uint64_t* storage = vectorBoolWords(data)) {
+        std::memcpy(storage, words, wordCount * sizeof(uint64_t));
+        storage[wordCount - 1] &= lastWordMask(data.size());
+        return;
+    }
+    for (std::size_t i = 0; i < data.size(); i++) {
+        data[i] = (words[i / BITS_PER_WORD] >> (i % BITS_PER_WORD)) & 1;
+    }
+}
+// Every standard library stores a bitset as an array of words with the same bit order
+template<std::size_t N> constexpr bool BITSET_IS_WORDS = std::is_trivially_copyable_v<std::bitset<N>> &&
+    sizeof(std::bitset<N>) == packedWordCount(N) * sizeof(uint64_t) && std::endian::native == std::endian::little;
+
+template<std::size_t N> constexpr void packBits(const std::bitset<N>& data, uint64_t* words) noexcept {
+    if constexpr (N == 0) {
+        return;
+    }
+    else if (!std::is_constant_evaluated() && BITSET_IS_WORDS<N>) {
+        std::memcpy(words, &data, sizeof(data));
+    }
+    else if (!std::is_constant_evaluated() && N <= BITS_PER_WORD) {
+        words[0] = data.to_ullong();
+    }
+    else {
+        for (std::size_t w = 0; w < packedWordCount(N); w++) {
+            words[w] = 0;
+        }
+        for (std::size_t i = 0; i < N; i++) {
+            words[i / BITS_PER_WORD] |= static_cast<uint64_t>(data[i]) << (i % BITS_PER_WORD);
+        }
+    }
+}
+template<std::size_t N> void unpackBits(const uint64_t* words, std::bitset<N>& data) noexcept {
+    constexpr std::size_t wordCount = packedWordCount(N);
+    if constexpr (N == 0) {
+        return;
+    }
+    else if constexpr (BITSET_IS_WORDS<N>) {
+        // The bits past N must stay zero
+        const uint64_t last = words[wordCount - 1] & lastWordMask(N);
+        void* destination = &data;
+        std::memcpy(destination, words, (wordCount - 1) * sizeof(uint64_t));
+        std::memcpy(static_cast<uint8_t*>(destination) + (wordCount - 1) * sizeof(uint64_t), &last, sizeof(uint64_t));
+    }
+    else if constexpr (N <= BITS_PER_WORD) {
+        data = std::bitset<N>(words[0] & lastWordMask(N));
+    }
+    else {
+        for (std::size_t i = 0; i < N; i++) {
+            data[i] = (words[i / BITS_PER_WORD] >> (i % BITS_PER_WORD)) & 1;
+        }
+    }
+}
+
+// A shared object written to an OutByteStream, keyed by address and type so aliasing pointers of different types stay apart
+struct SharedObjectKey {
+    const void* address;
+    std::type_index type;
+    bool operator==(const SharedObjectKey&) const = default;
+};
+struct SharedObjectKeyHash {
+    std::size_t operator()(const SharedObjectKey& key) const noexcept {
+        return std::hash<const void*>()(key.address) ^ key.type.hash_code();
+    }
+};
+// The id of a written shared object. The object is kept alive so its address cannot be reused by a different one.
+struct SharedObjectId {
+    std::size_t id;
+    std::shared_ptr<const void> owner;
+};
+using SharedObjectIds = std::unordered_map<SharedObjectKey, SharedObjectId, SharedObjectKeyHash>;
+// A shared object read from an InByteStream, later ids referring back to it must ask for the same type
+struct SharedObjectEntry {
+    std::shared_ptr<void> object;
+    std::type_index type;
+};
+using SharedObjectTable = std::vector<SharedObjectEntry>;
 
 class OutByteStream {
     friend class InByteStream;
 
     const std::string path;
-    std::ofstream fout;
+    const bool hasFile;
+    // Only opened by file streams, memory only streams are cheap to create as scratch space
+    std::unique_ptr<std::ofstream> fout;
 
     std::vector<uint8_t> bytes;
+    // Bytes that left the buffer, the position of bytes[0] in the output
+    std::size_t flushedBytes = 0;
+
+    // Ids of the shared objects already written to this stream, which holds them until it is destroyed
+    SharedObjectIds sharedIds;
+
+    StreamStats counters;
+    StreamStatsHook flushHook;
+
+    SerializationCache* serializationCache = nullptr;
+
+    void recordValue(std::size_t count) noexcept {
+        if constexpr (STREAM_STATS_ENABLED) {
+            counters.largestValue = std::max(counters.largestValue, count);
+        }
+    }
+    void writeOut(const uint8_t* data, std::size_t count) {
+        flushedBytes += count;
+        if constexpr (STREAM_STATS_ENABLED) {
+            const auto start = std::chrono::steady_clock::now();
+            fout->write(reinterpret_cast<const char*>(data), count);
+            counters.ioTime += std::chrono::steady_clock::now() - start;
+            counters.bytes += count;
+            counters.flushes += 1;
+            counters.ioCalls += 1;
+        }
+        else {
+            fout->write(reinterpret_cast<const char*>(data), count);
+        }
+    }
+    void notifyFlush() {
+        if constexpr (STREAM_STATS_ENABLED) {
+            if (flushHook) {
+                flushHook(stats());
+            }
+        }
+    }
 public:
-    explicit OutByteStream(const std::string& path, bool deletePath = true) noexcept : path{ path } {
+    // Memory only stream, bytes are never written to a file
+    OutByteStream() noexcept : hasFile{ false } {}
+    explicit OutByteStream(const std::string& path, bool deletePath = true) noexcept : path{ path }, hasFile{ true } {
         if (deletePath) {
             // Delete the file (will not fail if doesn't exist)
             auto result = std::filesystem::remove(path);
         }
-        fout.open(path, std::ios::out | std::ios::binary);
-    }
-    ~OutByteStream() {
-        fout.close();
+        fout = std::make_unique<std::ofstream>(path, std::ios::out | std::ios::binary);
     }
     void push(uint8_t byte) noexcept {
         bytes.push_back(byte);
-        if (bytes.size() >= BUFFER_REFILL_SIZE) {
+        if (hasFile && bytes.size() >= BUFFER_REFILL_SIZE) {
+            writeToFile();
+        }
+    }
+    void pushBytes(const uint8_t* data, std::size_t count) noexcept {
+        recordValue(count);
+        if (hasFile && count >= BUFFER_REFILL_SIZE) {
+            // Large values are written straight to the file instead of going through the buffer
+            if (!bytes.empty()) {
+                writeToFile();
+            }
+            writeOut(data, count);
+            notifyFlush();
+            return;
+        }
+        bytes.insert(bytes.end(), data, data + count);
+        if (hasFile && bytes.size() >= BUFFER_REFILL_SIZE) {
             writeToFile();
         }
     }
+    // Bytes that have not yet been written to the file
+    const std::vector<uint8_t>& buffer() const noexcept {
+        return bytes;
+    }
+    // Moves the bytes that have not yet been written to the file out of the stream
+    std::vector<uint8_t> releaseBuffer() noexcept {
+        flushedBytes += bytes.size();
+        if constexpr (STREAM_STATS_ENABLED) {
+            counters.bytes += bytes.size();
+        }
+        return std::exchange(bytes, {});
+    }
+    // Number of bytes pushed so far, the position of the next byte in the output
+    std::size_t position() const noexcept {
+        return flushedBytes + bytes.size();
+    }
+    // Overwrites bytes that were already pushed, seeks the file if they have been flushed
+    void patch(std::size_t at, const uint8_t* data, std::size_t count) {
+        assert(at + count <= position());
+        if (at >= flushedBytes) {
+            std::memcpy(bytes.data() + (at - flushedBytes), data, count);
+            return;
+        }
+        // Released bytes of a memory only stream cannot be patched
+        assert(hasFile);
+        // The part that is still buffered
+        if (at + count > flushedBytes) {
+            const std::size_t flushedPart = flushedBytes - at;
+            std::memcpy(bytes.data(), data + flushedPart, count - flushedPart);
+            count = flushedPart;
+        }
+        fout->seekp(static_cast<std::streamoff>(at));
+        fout->write(reinterpret_cast<const char*>(data), count);
+        fout->seekp(0, std::ios::end);
+        if constexpr (STREAM_STATS_ENABLED) {
+            counters.ioCalls += 1;
+        }
+    }
     void writeToFile() {
-        for (auto byte : bytes) {
-            fout.write((const char*)&byte, sizeof(uint8_t));
+        if (!hasFile) {
+            return;
         }
+        writeOut(bytes.data(), bytes.size());
         bytes.clear();
+        notifyFlush();
+    }
+    SharedObjectIds& sharedObjectIds() noexcept {
+        return sharedIds;
+    }
+    StreamStats stats() const noexcept {
+        StreamStats snapshot = counters;
+        if constexpr (STREAM_STATS_ENABLED) {
+            // Bytes still in the buffer have been pushed but not flushed
+            snapshot.bytes += bytes.size();
+        }
+        return snapshot;
+    }
+    void onFlush(StreamStatsHook hook) {
+        flushHook = std::move(hook);
+    }
+    // Cacheable values are looked up in cache, which must outlive the stream. nullptr detaches it.
+    void setCache(SerializationCache* cache) noexcept {
+        serializationCache = cache;
+    }
+    SerializationCache* cache() const noexcept {
+        return serializationCache;
     }
 };
+// Memory only stream with a fixed capacity that also works in constant evaluation, see serializeToArray().
+// Bytes past the capacity are counted but dropped, a capacity of 0 only measures the serialized size.
+template<std::size_t Capacity> class FixedOutByteStream {
+    std::array<uint8_t, Capacity> bytes = {};
+    std::size_t count = 0;
+public:
+    constexpr void push(uint8_t byte) noexcept {
+        if (count < Capacity) {
+            bytes[count] = byte;
+        }
+        count += 1;
+    }
+    constexpr void pushBytes(const uint8_t* data, std::size_t size) noexcept {
+        if (Capacity > 0 && !std::is_constant_evaluated() && count <= Capacity && size <= Capacity - count) {
+            std::memcpy(bytes.data() + count, data, size);
+            count += size;
+            return;
+        }
+        for (std::size_t i = 0; i < size; i++) {
+            push(data[i]);
+        }
+    }
+    constexpr const std::array<uint8_t, Capacity>& buffer() const noexcept {
+        return bytes;
+    }
+    // Number of bytes pushed so far, including the ones that did not fit
+    constexpr std::size_t position() const noexcept {
+        return count;
+    }
+    constexpr bool overflowed() const noexcept {
+        return count > Capacity;
+    }
+};
+// Streams the serialize overloads for values that can be built in constant evaluation write to
+template<typename T> concept ByteSink = requires(T& obs, const uint8_t* data, std::size_t count) {
+    obs.push(uint8_t{ 0 });
+    obs.pushBytes(data, count);
+};
+
+// Configuration of the read-ahead mode of InByteStream
+struct ReadAhead {
+    std::size_t buffers = 4;             // Buffers kept filled ahead of the decoder
+    std::size_t bufferSize = 64 * 1024;  // Bytes read from the file into each buffer
+};
+
+// Reads a file on a background thread into a bounded ring of buffers ahead of the decoder
+class Prefetcher {
+    std::ifstream file;
+    const std::size_t bufferSize;
+
+    std::vector<std::vector<uint8_t>> ring;
+    std::size_t head = 0;   // Next buffer the reader fills
+    std::size_t tail = 0;   // Next buffer the decoder takes
+    std::size_t filled = 0;
+    bool done = false;      // The reader has reached the end of the file
+    bool stopping = false;
+
+    std::mutex mutex;
+    std::condition_variable filledCondition;
+    std::condition_variable emptyCondition;
+    std::thread reader;
+
+    void run() {
+        while (true) {
+            std::vector<uint8_t> buffer;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                emptyCondition.wait(lock, [this]() { return stopping || filled < ring.size(); });
+                if (stopping) {
+                    return;
+                }
+                // The slot is not visible to the decoder until it is filled
+                buffer = std::move(ring[head]);
+            }
+            buffer.resize(bufferSize);
+            file.read(reinterpret_cast<char*>(buffer.data()), bufferSize);
+            buffer.resize(static_cast<std::size_t>(file.gcount()));
+            const bool end = buffer.size() < bufferSize;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ring[head] = std::move(buffer);
+                head = (head + 1) % ring.size();
+                filled += 1;
+                done = end;
+            }
+            filledCondition.notify_one();
+            if (end) {
+                return;
+            }
+        }
+    }
+public:
+    explicit Prefetcher(const std::string& path, const ReadAhead& readAhead)
+        : file{ std::ifstream(path, std::ios::binary) }, bufferSize{ std::max<std::size_t>(readAhead.bufferSize, 1) },
+        ring(std::max<std::size_t>(readAhead.buffers, 1)) {
+        reader = std::thread(&Prefetcher::run, this);
+    }
+    ~Prefetcher() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        emptyCondition.notify_one();
+        reader.join();
+    }
+    Prefetcher(const Prefetcher&) = delete;
+    Prefetcher& operator=(const Prefetcher&) = delete;
+
+    // Swaps the next filled buffer into bytes, blocks until the reader has one. Leaves bytes empty at the end of the file.
+    void next(std::vector<uint8_t>& bytes) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            filledCondition.wait(lock, [this]() { return filled > 0 || done; });
+            if (filled == 0) {
+                bytes.clear();
+                return;
+            }
+            // The old buffer goes back to the ring so its memory is reused
+            std::swap(bytes, ring[tail]);
+            ring[tail].clear();
+            tail = (tail + 1) % ring.size();
+            filled -= 1;
+        }
+        emptyCondition.notify_one();
+    }
+};
+
 class InByteStream {
     bool hasFile;
     std::ifstream file;
+    // Set in read-ahead mode, the file is then read by the prefetcher thread instead
+    std::unique_ptr<Prefetcher> prefetcher;
 
     std::size_t front = 0;
     std::vector<uint8_t> bytes;
+    // The bytes being decoded, either bytes or memory the stream does not own
+    const uint8_t* window = nullptr;
+    std::size_t windowSize = 0;
+
+    // Size of the whole input and position of window[0] in it
+    std::size_t inputSize = 0;
+    std::size_t bufferOffset = 0;
+
+    DecodeLimits decodeLimits;
+    DecodeError decodeError = DecodeError::None;
+    std::size_t depth = 0;
+
+    // Shared objects already read from this stream, indexed by id - 1
+    SharedObjectTable sharedObjects;
 
+    StreamStats counters;
+    StreamStatsHook refillHook;
+
+    void useBuffer() noexcept {
+        window = bytes.data();
+        windowSize = bytes.size();
+    }
+    // Reads up to count bytes from the file, timed and counted as one refill
+    std::size_t readFile(uint8_t* destination, std::size_t count) {
+        if constexpr (STREAM_STATS_ENABLED) {
+            const auto start = std::chrono::steady_clock::now();
+            file.read(reinterpret_cast<char*>(destination), count);
+            counters.ioTime += std::chrono::steady_clock::now() - start;
+            counters.refills += 1;
+            counters.ioCalls += 1;
+        }
+        else {
+            file.read(reinterpret_cast<char*>(destination), count);
+        }
+        return static_cast<std::size_t>(file.gcount());
+    }
+    void notifyRefill() {
+        if constexpr (STREAM_STATS_ENABLED) {
+            if (refillHook) {
+                refillHook(stats());
+            }
+        }
+    }
     void readBufferUntilSize(const std::size_t bufferSize) {
-        uint8_t byte = 0;
-        std::size_t count = 0;
-        while (file.read(reinterpret_cast<char*>(&byte), sizeof(uint8_t))) {
-            bytes.push_back(byte);
-            count++;
-            if (count >= bufferSize) {
-                break;
+        const std::size_t offset = bytes.size();
+        bytes.resize(offset + bufferSize);
+        bytes.resize(offset + readFile(bytes.data() + offset, bufferSize));
+        useBuffer();
+        notifyRefill();
+    }
+    void takePrefetchedBuffer() {
+        if constexpr (STREAM_STATS_ENABLED) {
+            // Only the time the decoder is blocked on the reader counts
+            const auto start = std::chrono::steady_clock::now();
+            prefetcher->next(bytes);
+            useBuffer();
+            counters.ioTime += std::chrono::steady_clock::now() - start;
+            counters.refills += 1;
+            counters.ioCalls += 1;
+            if (refillHook) {
+                refillHook(stats());
             }
         }
+        else {
+            prefetcher->next(bytes);
+            useBuffer();
+        }
+    }
+    // Called once the buffer is used up, false at the end of the input
+    bool refill() {
+        if (failed()) {
+            return false;
+        }
+        if (prefetcher) {
+            bufferOffset += windowSize;
+            front = 0;
+            takePrefetchedBuffer();
+        }
+        else if (hasFile) {
+            // we need to refill bytesBuffer
+            bufferOffset += windowSize;
+            front = 0;
+            bytes.clear();
+            readBufferUntilSize(BUFFER_REFILL_SIZE);
+        }
+        if (front == windowSize) {
+            fail(DecodeError::UnexpectedEnd);
+            return false;
+        }
+        return true;
     }
 public:
     explicit InByteStream(const std::string& path) : hasFile{ true }, file{ std::ifstream(path, std::ios::binary) } {
+        std::error_code ec;
+        const auto size = std::filesystem::file_size(path, ec);
+        inputSize = ec ? 0 : static_cast<std::size_t>(size);
         readBufferUntilSize(BUFFER_REFILL_SIZE);
     }
+    // Read-ahead mode: a background thread keeps readAhead.buffers buffers filled ahead of the decoder,
+    // which only blocks when it catches up with the reader
+    explicit InByteStream(const std::string& path, const ReadAhead& readAhead) : hasFile{ true }, prefetcher{ std::make_unique<Prefetcher>(path, readAhead) } {
+        std::error_code ec;
+        const auto size = std::filesystem::file_size(path, ec);
+        inputSize = ec ? 0 : static_cast<std::size_t>(size);
+    }
     // Invalidates the byteStream object
     explicit InByteStream(OutByteStream& byteStream) : hasFile{ false } {
         bytes = std::move(byteStream.bytes);
+        useBuffer();
+        inputSize = bytes.size();
+    }
+    // Reads memory the stream does not own in place, such as an array embedded in the binary.
+    // The memory must outlive the stream.
+    explicit InByteStream(std::span<const std::byte> memory) noexcept : hasFile{ false } {
+        window = reinterpret_cast<const uint8_t*>(memory.data());
+        windowSize = memory.size();
+        inputSize = memory.size();
     }
     uint8_t getByte() {
-        if (hasFile) {
-            if (front == bytes.size()) {
-                // we need to refill bytesBuffer
+        if (front == windowSize && !refill()) {
+            return 0;
+        }
+        uint8_t retval = window[front];
+        front += 1;
+        return retval;
+    }
+    // Copies the next count bytes to destination, the missing bytes are zeroed at the end of the input
+    void readBytes(uint8_t* destination, std::size_t count) {
+        if constexpr (STREAM_STATS_ENABLED) {
+            counters.largestValue = std::max(counters.largestValue, count);
+        }
+        if (failed()) {
+            // The direct file read below would otherwise return data past the point of failure
+            std::memset(destination, 0, count);
+            return;
+        }
+        while (count > 0) {
+            if (front == windowSize && hasFile && !prefetcher && count >= BUFFER_REFILL_SIZE) {
+                // Large values are read straight from the file instead of going through the buffer
+                bufferOffset += windowSize;
                 front = 0;
                 bytes.clear();
-                readBufferUntilSize(BUFFER_REFILL_SIZE);
+                useBuffer();
+                const std::size_t read = readFile(destination, count);
+                bufferOffset += read;
+                notifyRefill();
+                if (read < count) {
+                    fail(DecodeError::UnexpectedEnd);
+                    std::memset(destination + read, 0, count - read);
+                }
+                return;
+            }
+            if (front == windowSize && !refill()) {
+                std::memset(destination, 0, count);
+                return;
             }
+            const std::size_t available = std::min(count, windowSize - front);
+            std::memcpy(destination, window + front, available);
+            front += available;
+            destination += available;
+            count -= available;
         }
-        if (bytes.size() == 0 && front == 0) {
-            assert(false);
+    }
+    // Advance past count bytes without reading them, seeks the file if they are not buffered
+    void skipBytes(std::size_t count) {
+        if constexpr (STREAM_STATS_ENABLED) {
+            counters.largestValue = std::max(counters.largestValue, count);
         }
-        uint8_t retval = bytes.at(front);
-        front += 1;
-        return retval;
+        const std::size_t buffered = windowSize - front;
+        if (count <= buffered) {
+            front += count;
+            return;
+        }
+        if (count > remaining()) {
+            fail(DecodeError::UnexpectedEnd);
+            return;
+        }
+        if (prefetcher) {
+            // The reader cannot seek, whole buffers are dropped instead
+            count -= buffered;
+            front = windowSize;
+            while (count > 0 && refill()) {
+                const std::size_t dropped = std::min(count, windowSize);
+                front = dropped;
+                count -= dropped;
+            }
+            return;
+        }
+        bufferOffset += windowSize + (count - buffered);
+        front = 0;
+        bytes.clear();
+        file.seekg(static_cast<std::streamoff>(count - buffered), std::ios::cur);
+        if constexpr (STREAM_STATS_ENABLED) {
+            counters.ioCalls += 1;
+        }
+        readBufferUntilSize(BUFFER_REFILL_SIZE);
     }
     bool isEmpty() const noexcept {
+        if (prefetcher) {
+            return remaining() == 0;
+        }
         if (hasFile) {
-            return file.eof() && (0 == bytes.size() || (front == bytes.size() - 1));
+            return file.eof() && (0 == windowSize || (front == windowSize - 1));
         }
         else {
-            return front == bytes.size();
+            return front == windowSize;
         }
     }
+
+    // Bytes read or skipped so far
+    std::size_t consumed() const noexcept {
+        return bufferOffset + front;
+    }
+    // Bytes left in the input
+    std::size_t remaining() const noexcept {
+        return inputSize > consumed() ? inputSize - consumed() : 0;
+    }
+
+    void setLimits(const DecodeLimits& limits) noexcept {
+        decodeLimits = limits;
+    }
+    const DecodeLimits& limits() const noexcept {
+        return decodeLimits;
+    }
+    // The first error hit while decoding, once set every read returns 0
+    DecodeError error() const noexcept {
+        return decodeError;
+    }
+    bool failed() const noexcept {
+        return decodeError != DecodeError::None;
+    }
+    void fail(DecodeError error) noexcept {
+        if (decodeError == DecodeError::None) {
+            decodeError = error;
+        }
+        // Nothing more can be read after an error
+        bufferOffset += front;
+        front = 0;
+        bytes.clear();
+        useBuffer();
+        inputSize = 0;
+    }
+    // Checks a decoded length of count elements, each serialized to at least minElementSize bytes
+    bool acceptLength(std::size_t count, std::size_t minElementSize) noexcept {
+        if (count > decodeLimits.maxElements) {
+            fail(DecodeError::TooManyElements);
+            return false;
+        }
+        if (minElementSize != 0) {
+            if (count > remaining() / minElementSize) {
+                fail(DecodeError::LengthExceedsInput);
+                return false;
+            }
+            const std::size_t budget = decodeLimits.maxBytes > consumed() ? decodeLimits.maxBytes - consumed() : 0;
+            if (count > budget / minElementSize) {
+                fail(DecodeError::TooManyBytes);
+                return false;
+            }
+        }
+        return true;
+    }
+    // Containers call enterScope()/leaveScope() around their elements to bound the nesting depth
+    bool enterScope() noexcept {
+        if (depth >= decodeLimits.maxDepth) {
+            fail(DecodeError::TooDeep);
+            return false;
+        }
+        depth += 1;
+        return true;
+    }
+    void leaveScope() noexcept {
+        depth -= 1;
+    }
+
+    SharedObjectTable& sharedObjectTable() noexcept {
+        return sharedObjects;
+    }
+
+    StreamStats stats() const noexcept {
+        StreamStats snapshot = counters;
+        if constexpr (STREAM_STATS_ENABLED) {
+            snapshot.bytes = consumed();
+        }
+        return snapshot;
+    }
+    void onRefill(StreamStatsHook hook) {
+        refillHook = std::move(hook);
+    }
+};
+
+// Enters a nesting level of an InByteStream for the lifetime of the object
+class DecodeScope {
+    InByteStream& ibs;
+    const bool entered;
+public:
+    explicit DecodeScope(InByteStream& ibs) noexcept : ibs{ ibs }, entered{ ibs.enterScope() } {}
+    ~DecodeScope() {
+        if (entered) {
+            ibs.leaveScope();
+        }
+    }
+    DecodeScope(const DecodeScope&) = delete;
+    DecodeScope& operator=(const DecodeScope&) = delete;
+
+    explicit operator bool() const noexcept {
+        return entered;
+    }
 };
 
 #endif // !__HEADER_BYTESTREAMS_H_
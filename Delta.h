@@ -0,0 +1,159 @@
+#ifndef __HEADER_DELTA_H_
+#define __HEADER_DELTA_H_
+
+#include "ByteStreams.h"
+#include "Serialize.h"
+#include "Deserialize.h"
+
+// Incremental snapshots of a map or unordered_map.
+// A base snapshot is a plain serialize(map), a delta holds only the entries that changed since the previous snapshot.
+// The latest state is the base with every delta applied in order, compactSnapshot() folds them into a new base.
+//
+// A delta is the record count followed by the records, each an operation, a key and for inserts/updates the value.
+
+enum class DeltaOp : uint8_t {
+    Insert,
+    Update,
+    Erase,
+};
+
+template<typename T> requires isMap<T> class DeltaWriter {
+    using K = typename T::key_type;
+    using V = typename T::mapped_type;
+
+    OutByteStream& obs;
+    const std::size_t countPosition;
+    std::size_t count = 0;
+    bool finished = false;
+public:
+    explicit DeltaWriter(OutByteStream& obs) noexcept : obs{ obs }, countPosition{ obs.position() } {
+        serialize(std::size_t{ 0 }, obs);
+    }
+    DeltaWriter(const DeltaWriter&) = delete;
+    DeltaWriter& operator=(const DeltaWriter&) = delete;
+    ~DeltaWriter() {
+        finish();
+    }
+    void insert(const K& key, const V& value) noexcept {
+        write(DeltaOp::Insert, key);
+        serialize(value, obs);
+    }
+    void update(const K& key, const V& value) noexcept {
+        write(DeltaOp::Update, key);
+        serialize(value, obs);
+    }
+    void erase(const K& key) noexcept {
+        write(DeltaOp::Erase, key);
+    }
+    std::size_t size() const noexcept {
+        return count;
+    }
+    // Writes the final record count, nothing can be written afterwards
+    void finish() {
+        if (finished) {
+            return;
+        }
+        uint8_t encoded[sizeof(std::size_t)];
+        std::memcpy(encoded, &count, sizeof(std::size_t));
+        obs.patch(countPosition, encoded, sizeof(std::size_t));
+        finished = true;
+    }
+private:
+    void write(DeltaOp op, const K& key) noexcept {
+        assert(!finished);
+        serialize(static_cast<uint8_t>(op), obs);
+        serialize(key, obs);
+        count++;
+    }
+};
+
+// Writes the changes that turn base into current
+template<typename T> requires isMap<T> void serializeDelta(const T& base, const T& current, OutByteStream& obs) noexcept {
+    DeltaWriter<T> writer = DeltaWriter<T>(obs);
+    for (const auto& [key, value] : current) {
+        const auto it = base.find(key);
+        if (it == base.end()) {
+            writer.insert(key, value);
+        }
+        else if (!(it->second == value)) {
+            writer.update(key, value);
+        }
+    }
+    for (const auto& [key, value] : base) {
+        if (current.find(key) == current.end()) {
+            writer.erase(key);
+        }
+    }
+}
+
+// Writes only the keys known to have changed, the cost does not depend on the size of the map.
+// A dirty key still in current is written as an update (inserted when applied if it is new), otherwise as an erase.
+template<typename T, typename Keys> requires isMap<T> void serializeDirty(const T& current, const Keys& dirtyKeys, OutByteStream& obs) noexcept {
+    DeltaWriter<T> writer = DeltaWriter<T>(obs);
+    for (const auto& key : dirtyKeys) {
+        const auto it = current.find(key);
+        if (it == current.end()) {
+            writer.erase(key);
+        }
+        else {
+            writer.update(key, it->second);
+        }
+    }
+}
+
+// Applies one delta to state, stops at the first invalid record (see InByteStream::error())
+template<typename T> requires isMap<T> void applyDelta(T& state, InByteStream& ibs) {
+    using K = typename T::key_type;
+    using V = typename T::mapped_type;
+    const std::size_t count = deserialize<std::size_t>(ibs);
+    if (!ibs.acceptLength(count, sizeof(uint8_t) + minSerializedSize<K>)) {
+        return;
+    }
+    for (std::size_t i = 0; i < count && !ibs.failed(); i++) {
+        const uint8_t op = deserialize<uint8_t>(ibs);
+        K key = deserialize<K>(ibs);
+        switch (static_cast<DeltaOp>(op)) {
+        case DeltaOp::Insert:
+        case DeltaOp::Update:
+            state.insert_or_assign(std::move(key), deserialize<V>(ibs));
+            break;
+        case DeltaOp::Erase:
+            state.erase(key);
+            break;
+        default:
+            ibs.fail(DecodeError::InvalidDeltaRecord);
+            break;
+        }
+    }
+}
+
+// Reads a base snapshot and applies the deltas in order
+template<typename T> requires isMap<T> DecodeResult<T> loadSnapshot(const std::string& basePath, const std::vector<std::string>& deltaPaths) {
+    InByteStream base = InByteStream(basePath);
+    DecodeResult<T> state = tryDeserialize<T>(base);
+    if (!state) {
+        return state;
+    }
+    for (const std::string& path : deltaPaths) {
+        InByteStream delta = InByteStream(path);
+        applyDelta(*state, delta);
+        if (delta.failed()) {
+            return DecodeResult<T>(delta.error());
+        }
+    }
+    return state;
+}
+
+// Merges a base snapshot and its deltas into a new base snapshot at outPath
+template<typename T> requires isMap<T> DecodeError compactSnapshot(const std::string& basePath, const std::vector<std::string>& deltaPaths, const std::string& outPath) {
+    const DecodeResult<T> state = loadSnapshot<T>(basePath, deltaPaths);
+    if (!state) {
+        return state.error();
+    }
+    OutByteStream obs = OutByteStream(outPath);
+    serialize(*state, obs);
+    obs.writeToFile();
+    return DecodeError::None;
+}
+
+#endif // !__HEADER_DELTA_H_
@@ -3,34 +3,61 @@
 
 #include "ByteStreams.h"
 
+#include <new>
+#include <optional>
+
 // Only specialization are allowed
 template<typename T> T deserialize(InByteStream& ibs) = delete;
 
 template<typename T> requires Arithmetic<T> T deserialize(InByteStream& ibs) {
     constexpr const std::size_t size = sizeof(T);
     uint8_t s[size] = {};
-    for (std::size_t i = 0; i < size; i++) {
-        s[i] = ibs.getByte();
-    }
-    const T* b = (T*)s;
-    const T c = *b;
+    ibs.readBytes(s, size);
+    T c;
+    std::memcpy(&c, s, size);
     return c;
 }
-template<> std::string deserialize<std::string>(InByteStream& ibs) {
+template<> inline std::string deserialize<std::string>(InByteStream& ibs) {
     std::string retval;
     const std::size_t size = deserialize<std::size_t>(ibs);
-    for (std::size_t i = 0; i < size; i++) {
-        char c = deserialize<char>(ibs);
-        retval += c;
+    if (!ibs.acceptLength(size, sizeof(char))) {
+        return retval;
     }
+    retval.resize(size);
+    ibs.readBytes(reinterpret_cast<uint8_t*>(retval.data()), size * sizeof(char));
     return retval;
 }
 template<typename T> requires isVector<T> T deserialize(InByteStream& ibs) {
     using B = typename T::value_type;
     T retval = {};
     const std::size_t size = deserialize<std::size_t>(ibs);
-    for (std::size_t i = 0; i < size; i++) {
-        retval.push_back(deserialize<B>(ibs));
+    if constexpr (std::same_as<B, bool>) {
+        // Packed into words, the element count is checked against the number of bits instead of bytes
+        const std::size_t wordCount = packedWordCount(size);
+        if (!ibs.acceptLength(size, 0) || !ibs.acceptLength(wordCount, sizeof(uint64_t))) {
+            return retval;
+        }
+        std::vector<uint64_t> words(wordCount);
+        ibs.readBytes(reinterpret_cast<uint8_t*>(words.data()), wordCount * sizeof(uint64_t));
+        retval.resize(size);
+        unpackBits(words.data(), retval);
+        return retval;
+    }
+    const DecodeScope scope(ibs);
+    if (!scope || !ibs.acceptLength(size, minSerializedSize<B>)) {
+        return retval;
+    }
+    if constexpr (Arithmetic<B> && !std::same_as<B, bool>) {
+        retval.resize(size);
+        ibs.readBytes(reinterpret_cast<uint8_t*>(retval.data()), size * sizeof(B));
+    }
+    else {
+        // Elements of user types may have no lower bound on their size and can be much larger in memory than
+        // encoded, the reservation is bounded by as many bytes as there are left in the input
+        retval.reserve(std::min(size, ibs.remaining() / sizeof(B)));
+        for (std::size_t i = 0; i < size && !ibs.failed(); i++) {
+            retval.push_back(deserialize<B>(ibs));
+        }
     }
     return retval;
 }
@@ -38,7 +65,11 @@ template<typename T> requires isSet<T> T deserialize(InByteStream& ibs) {
     using B = typename T::key_type;
     T retval = {};
     const std::size_t size = deserialize<std::size_t>(ibs);
-    for (std::size_t i = 0; i < size; i++) {
+    const DecodeScope scope(ibs);
+    if (!scope || !ibs.acceptLength(size, minSerializedSize<B>)) {
+        return retval;
+    }
+    for (std::size_t i = 0; i < size && !ibs.failed(); i++) {
         retval.insert(deserialize<B>(ibs));
     }
     return retval;
@@ -48,14 +79,240 @@ template<typename T> requires isMap<T> T deserialize(InByteStream& ibs) {
     using B = typename T::mapped_type;
     T retval = {};
     const std::size_t size = deserialize<std::size_t>(ibs);
-    for (std::size_t i = 0; i < size; i++) {
+    const DecodeScope scope(ibs);
+    if (!scope || !ibs.acceptLength(size, minSerializedSize<A> + minSerializedSize<B>)) {
+        return retval;
+    }
+    for (std::size_t i = 0; i < size && !ibs.failed(); i++) {
+        // Braced initialization keeps the key decoded before the value
         retval.insert({ deserialize<A>(ibs), deserialize<B>(ibs) });
     }
     return retval;
 }
+// Reads a FixedSize value from exactly fixedSerializedSize<T> bytes
+template<typename T> T readFixed(const uint8_t* in) noexcept {
+    if constexpr (Arithmetic<T>) {
+        T value;
+        std::memcpy(&value, in, sizeof(T));
+        return value;
+    }
+    else if constexpr (isBitset<T>) {
+        uint64_t words[fixedSerializedSize<T> / sizeof(uint64_t)];
+        std::memcpy(words, in, sizeof(words));
+        T value;
+        unpackBits(words, value);
+        return value;
+    }
+    else if constexpr (isArray<T>) {
+        using B = typename T::value_type;
+        T value;
+        if constexpr (Arithmetic<B>) {
+            std::memcpy(value.data(), in, value.size() * sizeof(B));
+        }
+        else {
+            for (std::size_t i = 0; i < value.size(); i++) {
+                value[i] = readFixed<B>(in + i * fixedSerializedSize<B>);
+            }
+        }
+        return value;
+    }
+    else {
+        return [&]<std::size_t... I>(std::index_sequence<I...>) {
+            return T(readFixed<std::tuple_element_t<I, T>>(in + fixedElementOffset<T, I>)...);
+        }(std::make_index_sequence<std::tuple_size_v<T>>{});
+    }
+}
+template<typename T> requires isArray<T> || isPair<T> || isTuple<T> T deserialize(InByteStream& ibs) {
+    if constexpr (isArithmeticArray<T>) {
+        T retval;
+        ibs.readBytes(reinterpret_cast<uint8_t*>(retval.data()), retval.size() * sizeof(typename T::value_type));
+        return retval;
+    }
+    else if constexpr (FixedSize<T> && fixedSerializedSize<T> <= FIXED_BUFFER_SIZE) {
+        uint8_t buffer[fixedSerializedSize<T>];
+        ibs.readBytes(buffer, fixedSerializedSize<T>);
+        return readFixed<T>(buffer);
+    }
+    else if constexpr (isArray<T>) {
+        using B = typename T::value_type;
+        return [&]<std::size_t... I>(std::index_sequence<I...>) {
+            // Braced initialization keeps the elements decoded in order
+            return T{ (static_cast<void>(I), deserialize<B>(ibs))... };
+        }(std::make_index_sequence<std::tuple_size_v<T>>{});
+    }
+    else {
+        return [&]<std::size_t... I>(std::index_sequence<I...>) {
+            return T{ deserialize<std::tuple_element_t<I, T>>(ibs)... };
+        }(std::make_index_sequence<std::tuple_size_v<T>>{});
+    }
+}
+template<typename T> requires isBitset<T> T deserialize(InByteStream& ibs) {
+    T retval;
+    if constexpr (FixedSize<T>) {
+        uint64_t words[fixedSerializedSize<T> / sizeof(uint64_t)];
+        ibs.readBytes(reinterpret_cast<uint8_t*>(words), sizeof(words));
+        unpackBits(words, retval);
+    }
+    return retval;
+}
+template<typename T> requires isOptional<T> T deserialize(InByteStream& ibs) {
+    using B = typename T::value_type;
+    if (!deserialize<bool>(ibs)) {
+        return std::nullopt;
+    }
+    return T(std::in_place, deserialize<B>(ibs));
+}
+// The alternative is decoded through a table indexed by the variant index
+template<typename T> requires isVariant<T> T deserialize(InByteStream& ibs) {
+    using Reader = T(*)(InByteStream&);
+    constexpr auto readers = []<std::size_t... I>(std::index_sequence<I...>) {
+        return std::array<Reader, sizeof...(I)>{ [](InByteStream& ibs) {
+            return T(std::in_place_index<I>, deserialize<std::variant_alternative_t<I, T>>(ibs));
+        }... };
+    }(std::make_index_sequence<std::variant_size_v<T>>{});
+    const std::size_t index = deserialize<VariantIndex<T>>(ibs);
+    if (index >= readers.size()) {
+        ibs.fail(DecodeError::InvalidVariantIndex);
+        // Decoding from a failed stream only reads zeros
+        return readers[0](ibs);
+    }
+    return readers[index](ibs);
+}
+
+// Owns a shared object that is registered before it is constructed
+template<typename T> class SharedObjectStorage {
+    alignas(T) unsigned char storage[sizeof(T)];
+    bool constructed = false;
+public:
+    SharedObjectStorage() noexcept = default;
+    SharedObjectStorage(const SharedObjectStorage&) = delete;
+    SharedObjectStorage& operator=(const SharedObjectStorage&) = delete;
+    ~SharedObjectStorage() {
+        if (constructed) {
+            get()->~T();
+        }
+    }
+    T* get() noexcept {
+        return reinterpret_cast<T*>(storage);
+    }
+    void construct(InByteStream& ibs);
+};
+template<typename T> requires isSharedPtr<T> T deserialize(InByteStream& ibs) {
+    using B = std::remove_cv_t<typename T::element_type>;
+    auto& objects = ibs.sharedObjectTable();
+    const std::size_t id = deserialize<std::size_t>(ibs);
+    if (id == 0) {
+        return nullptr;
+    }
+    if (id <= objects.size()) {
+        if (objects[id - 1].type != std::type_index(typeid(B))) {
+            ibs.fail(DecodeError::InvalidReference);
+            return nullptr;
+        }
+        return std::static_pointer_cast<B>(objects[id - 1].object);
+    }
+    if (id != objects.size() + 1) {
+        ibs.fail(DecodeError::InvalidReference);
+        return nullptr;
+    }
+    const DecodeScope scope(ibs);
+    if (!scope) {
+        return nullptr;
+    }
+    // The object is registered before it is decoded so cycles back to it resolve to the same pointer
+    auto storage = std::make_shared<SharedObjectStorage<B>>();
+    std::shared_ptr<B> object = std::shared_ptr<B>(storage, storage->get());
+    objects.push_back(SharedObjectEntry{ object, std::type_index(typeid(B)) });
+    storage->construct(ibs);
+    return object;
+}
+template<typename T> requires isUniquePtr<T> T deserialize(InByteStream& ibs) {
+    using B = typename T::element_type;
+    if (!deserialize<bool>(ibs)) {
+        return nullptr;
+    }
+    const DecodeScope scope(ibs);
+    if (!scope) {
+        return nullptr;
+    }
+    return std::make_unique<B>(deserialize<std::remove_cv_t<B>>(ibs));
+}
 template<typename T> requires Deserializable<T> T deserialize(InByteStream& ibs) {
-    return T(ibs);
+    if constexpr (LengthPrefixed<T>) {
+        const std::size_t length = deserialize<std::size_t>(ibs);
+        ibs.acceptLength(length, 1);
+        const std::size_t start = ibs.consumed();
+        T retval = T(ibs);
+        const std::size_t read = ibs.consumed() - start;
+        if (read > length) {
+            ibs.fail(DecodeError::LengthMismatch);
+        }
+        else if (read < length) {
+            // Trailing bytes the type does not know about, e.g. fields added by a newer writer
+            ibs.skipBytes(length - read);
+        }
+        return retval;
+    }
+    else {
+        return T(ibs);
+    }
 }
 
-#endif // !__HEADER_DESERIALIZE_H_
+template<typename T> void SharedObjectStorage<T>::construct(InByteStream& ibs) {
+    new (storage) T(deserialize<T>(ibs));
+    constructed = true;
+}
+
+// Result of tryDeserialize(), holds either the decoded value or the error that stopped decoding
+template<typename T> class DecodeResult {
+    std::optional<T> result;
+    DecodeError decodeError = DecodeError::None;
+public:
+    DecodeResult(T value) noexcept(std::is_nothrow_move_constructible_v<T>) : result{ std::move(value) } {}
+    DecodeResult(DecodeError error) noexcept : decodeError{ error } {}
+
+    bool hasValue() const noexcept {
+        return result.has_value();
+    }
+    explicit operator bool() const noexcept {
+        return result.has_value();
+    }
+    T& value() & {
+        return *result;
+    }
+    const T& value() const& {
+        return *result;
+    }
+    T&& value() && {
+        return std::move(*result);
+    }
+    T& operator*() & {
+        return *result;
+    }
+    const T& operator*() const& {
+        return *result;
+    }
+    T* operator->() {
+        return &*result;
+    }
+    const T* operator->() const {
+        return &*result;
+    }
+    DecodeError error() const noexcept {
+        return decodeError;
+    }
+};
 
+// Deserializes without asserting or throwing on corrupt input, the limits set on the stream are enforced
+template<typename T> DecodeResult<T> tryDeserialize(InByteStream& ibs) {
+    T value = deserialize<T>(ibs);
+    if (!ibs.failed() && ibs.consumed() > ibs.limits().maxBytes) {
+        ibs.fail(DecodeError::TooManyBytes);
+    }
+    if (ibs.failed()) {
+        return DecodeResult<T>(ibs.error());
+    }
+    return DecodeResult<T>(std::move(value));
+}
+
+#endif // !__HEADER_DESERIALIZE_H_
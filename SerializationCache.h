@@ -0,0 +1,115 @@
+#ifndef __HEADER_SERIALIZATIONCACHE_H_
+#define __HEADER_SERIALIZATIONCACHE_H_
+
+#include "ByteStreams.h"
+
+#include <list>
+
+// Memoized encodings of Cacheable values.
+// Attach a cache to a stream with OutByteStream::setCache(). A Cacheable value is then looked up by its type and
+// T::cacheKey(), and on a hit its serialized bytes are appended with a single pushBytes() instead of being encoded again.
+// Least recently used entries are evicted once the cached bytes exceed the memory cap.
+// One cache can be shared by any number of streams and threads.
+
+struct CacheStats {
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+    std::size_t evictions = 0;
+    std::size_t entries = 0;
+    std::size_t bytes = 0;      // Serialized bytes held by the entries
+};
+
+class SerializationCache {
+public:
+    // Entries are shared so a hit can be appended after the lock is released, even if it is evicted meanwhile
+    using Bytes = std::shared_ptr<const std::vector<uint8_t>>;
+private:
+    struct Key {
+        const void* type;
+        uint64_t hash;
+        bool operator==(const Key&) const = default;
+    };
+    struct KeyHash {
+        std::size_t operator()(const Key& key) const noexcept {
+            return std::hash<const void*>()(key.type) ^ static_cast<std::size_t>(key.hash * 0x9E3779B97F4A7C15ull);
+        }
+    };
+    struct Entry {
+        Key key;
+        Bytes bytes;
+    };
+
+    mutable std::mutex mutex;
+    // Most recently used first
+    std::list<Entry> entries;
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+    std::size_t byteLimit;
+    CacheStats counters;
+
+    // One address per type, keys of different types never collide
+    template<typename T> static const void* typeKey() noexcept {
+        static const char tag = 0;
+        return &tag;
+    }
+    void evictUntil(std::size_t limit) {
+        while (counters.bytes > limit && !entries.empty()) {
+            const Entry& entry = entries.back();
+            counters.bytes -= entry.bytes->size();
+            counters.evictions += 1;
+            index.erase(entry.key);
+            entries.pop_back();
+        }
+    }
+public:
+    explicit SerializationCache(std::size_t maxBytes) noexcept : byteLimit{ maxBytes } {}
+    SerializationCache(const SerializationCache&) = delete;
+    SerializationCache& operator=(const SerializationCache&) = delete;
+
+    // The cached encoding of the T with the given key, nullptr on a miss
+    template<typename T> Bytes find(uint64_t key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        const auto it = index.find(Key{ typeKey<T>(), key });
+        if (it == index.end()) {
+            counters.misses += 1;
+            return nullptr;
+        }
+        counters.hits += 1;
+        entries.splice(entries.begin(), entries, it->second);
+        return it->second->bytes;
+    }
+    // Encodings larger than the memory cap are not kept
+    template<typename T> void insert(uint64_t key, std::vector<uint8_t>&& bytes) {
+        std::lock_guard<std::mutex> lock(mutex);
+        const Key entryKey = Key{ typeKey<T>(), key };
+        if (bytes.size() > byteLimit || index.contains(entryKey)) {
+            return;
+        }
+        counters.bytes += bytes.size();
+        entries.push_front(Entry{ entryKey, std::make_shared<const std::vector<uint8_t>>(std::move(bytes)) });
+        index.emplace(entryKey, entries.begin());
+        evictUntil(byteLimit);
+    }
+
+    std::size_t maxBytes() const noexcept {
+        std::lock_guard<std::mutex> lock(mutex);
+        return byteLimit;
+    }
+    // Lowering the cap evicts entries right away
+    void setMaxBytes(std::size_t maxBytes) {
+        std::lock_guard<std::mutex> lock(mutex);
+        byteLimit = maxBytes;
+        evictUntil(byteLimit);
+    }
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        evictUntil(0);
+    }
+    CacheStats stats() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        CacheStats snapshot = counters;
+        snapshot.entries = entries.size();
+        return snapshot;
+    }
+};
+
+#endif // !__HEADER_SERIALIZATIONCACHE_H_
@@ -2,27 +2,48 @@
 #define __HEADER_SERIALIZE_H_
 
 #include "ByteStreams.h"
+#include "SerializationCache.h"
 
 // Only specialization are allowed
-template<typename T> void serialize(const T& data, OutByteStream& obs) noexcept = delete;
+template<typename T, typename Out> void serialize(const T& data, Out& obs) noexcept = delete;
 
-template<typename T> requires Arithmetic<T> void serialize(const T& data, OutByteStream& obs) noexcept {
-    constexpr const std::size_t size = sizeof(T);
-    const uint8_t* a = (uint8_t*)&data;
-    for (std::size_t i = 0; i < size; i++) {
-        obs.push(a[i]);
+// Pushes count arithmetic values as they are laid out in memory.
+// Constant evaluation cannot reinterpret a value as bytes, each value is converted with std::bit_cast instead.
+template<typename T, ByteSink Out> constexpr void pushValues(const T* data, std::size_t count, Out& obs) noexcept {
+    if (std::is_constant_evaluated()) {
+        for (std::size_t i = 0; i < count; i++) {
+            const auto raw = std::bit_cast<std::array<uint8_t, sizeof(T)>>(data[i]);
+            obs.pushBytes(raw.data(), sizeof(T));
+        }
+    }
+    else {
+        obs.pushBytes(reinterpret_cast<const uint8_t*>(data), count * sizeof(T));
     }
 }
-template<> void serialize(const std::string& data, OutByteStream& obs) noexcept {
+
+// Overloads templated on the stream also write to a FixedOutByteStream, in constant evaluation too
+template<typename T, ByteSink Out> requires Arithmetic<T> constexpr void serialize(const T& data, Out& obs) noexcept {
+    pushValues(&data, 1, obs);
+}
+template<ByteSink Out> constexpr void serialize(const std::string& data, Out& obs) noexcept {
     serialize(data.size(), obs);
-    for (const char c : data) {
-        serialize(c, obs);
-    }
+    pushValues(data.data(), data.size(), obs);
 }
-template<typename T> void serialize(const std::vector<T>& data, OutByteStream& obs) noexcept {
+template<typename T, ByteSink Out> constexpr void serialize(const std::vector<T>& data, Out& obs) noexcept {
     serialize(data.size(), obs);
-    for (const T& elem : data) {
-        serialize(elem, obs);
+    if constexpr (std::same_as<T, bool>) {
+        // One bit per element, packed a word at a time
+        std::vector<uint64_t> words(packedWordCount(data.size()));
+        packBits(data, words.data());
+        pushValues(words.data(), words.size(), obs);
+    }
+    else if constexpr (Arithmetic<T>) {
+        pushValues(data.data(), data.size(), obs);
+    }
+    else {
+        for (const T& elem : data) {
+            serialize(elem, obs);
+        }
     }
 }
 template<typename T> void serialize(const std::set<T>& data, OutByteStream& obs) noexcept {
@@ -51,8 +72,258 @@ template<typename T, typename U> void serialize(const std::unordered_map<T, U>&
         serialize(value, obs);
     }
 }
+// Writes a FixedSize value to exactly fixedSerializedSize<T> bytes
+template<typename T> constexpr void writeFixed(const T& data, uint8_t* out) noexcept {
+    if constexpr (Arithmetic<T>) {
+        if (std::is_constant_evaluated()) {
+            const auto raw = std::bit_cast<std::array<uint8_t, sizeof(T)>>(data);
+            std::copy(raw.begin(), raw.end(), out);
+        }
+        else {
+            std::memcpy(out, &data, sizeof(T));
+        }
+    }
+    else if constexpr (isBitset<T>) {
+        uint64_t words[fixedSerializedSize<T> / sizeof(uint64_t)];
+        packBits(data, words);
+        for (std::size_t w = 0; w < std::size(words); w++) {
+            writeFixed(words[w], out + w * sizeof(uint64_t));
+        }
+    }
+    else if constexpr (isArray<T>) {
+        using B = typename T::value_type;
+        if (Arithmetic<B> && !std::is_constant_evaluated()) {
+            std::memcpy(out, data.data(), data.size() * sizeof(B));
+        }
+        else {
+            for (std::size_t i = 0; i < data.size(); i++) {
+                writeFixed(data[i], out + i * fixedSerializedSize<B>);
+            }
+        }
+    }
+    else {
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            (writeFixed(std::get<I>(data), out + fixedElementOffset<T, I>), ...);
+        }(std::make_index_sequence<std::tuple_size_v<T>>{});
+    }
+}
+// Arrays, pairs and tuples have no length prefix, fixed size ones are pushed with a single copy
+template<typename T, ByteSink Out> requires isArray<T> || isPair<T> || isTuple<T> constexpr void serialize(const T& data, Out& obs) noexcept {
+    if constexpr (isArithmeticArray<T>) {
+        pushValues(data.data(), data.size(), obs);
+    }
+    else if constexpr (FixedSize<T> && fixedSerializedSize<T> <= FIXED_BUFFER_SIZE) {
+        uint8_t buffer[fixedSerializedSize<T>];
+        writeFixed(data, buffer);
+        obs.pushBytes(buffer, fixedSerializedSize<T>);
+    }
+    else if constexpr (isArray<T>) {
+        for (const auto& elem : data) {
+            serialize(elem, obs);
+        }
+    }
+    else {
+        std::apply([&obs](const auto&... elems) {
+            (serialize(elems, obs), ...);
+        }, data);
+    }
+}
+// A bitset has no length prefix, its bits are packed into words
+template<std::size_t N, ByteSink Out> constexpr void serialize(const std::bitset<N>& data, Out& obs) noexcept {
+    if constexpr (N > 0) {
+        uint64_t words[packedWordCount(N)];
+        packBits(data, words);
+        pushValues(words, packedWordCount(N), obs);
+    }
+}
+template<typename T, ByteSink Out> constexpr void serialize(const std::optional<T>& data, Out& obs) noexcept {
+    serialize(data.has_value(), obs);
+    if (data) {
+        serialize(*data, obs);
+    }
+}
+// The index is followed by the active alternative, written through a table indexed by the variant index
+template<ByteSink Out, typename... Ts> constexpr void serialize(const std::variant<Ts...>& data, Out& obs) noexcept {
+    using T = std::variant<Ts...>;
+    using Writer = void(*)(const T&, Out&);
+    constexpr auto writers = []<std::size_t... I>(std::index_sequence<I...>) {
+        return std::array<Writer, sizeof...(I)>{ [](const T& variant, Out& obs) {
+            serialize(*std::get_if<I>(&variant), obs);
+        }... };
+    }(std::index_sequence_for<Ts...>{});
+    serialize(static_cast<VariantIndex<T>>(data.index()), obs);
+    // A valueless variant only writes an index that is out of range
+    if (!data.valueless_by_exception()) {
+        writers[data.index()](data, obs);
+    }
+}
+// Every shared object is written once, later references to the same object only write its id.
+// The id is 0 for nullptr and the object follows when the id is seen for the first time.
+template<typename T> void serialize(const std::shared_ptr<T>& data, OutByteStream& obs) noexcept {
+    if (!data) {
+        serialize(std::size_t{ 0 }, obs);
+        return;
+    }
+    auto& ids = obs.sharedObjectIds();
+    const SharedObjectKey key = SharedObjectKey{ static_cast<const void*>(data.get()), std::type_index(typeid(T)) };
+    const auto [it, inserted] = ids.try_emplace(key, SharedObjectId{ ids.size() + 1, data });
+    serialize(it->second.id, obs);
+    if (inserted) {
+        // The id is assigned before the object is written so cycles back to it are references
+        serialize(*data, obs);
+    }
+}
+template<typename T> void serialize(const std::unique_ptr<T>& data, OutByteStream& obs) noexcept {
+    serialize(static_cast<bool>(data), obs);
+    if (data) {
+        serialize(*data, obs);
+    }
+}
+// Encodes a Serializable type without going through the cache
+template<typename T> requires Serializable<T> void serializeValue(const T& data, OutByteStream& obs) noexcept {
+    if constexpr (LengthPrefixed<T>) {
+        // The byte length is reserved ahead of the payload and patched in once it is known
+        const std::size_t lengthPosition = obs.position();
+        serialize(std::size_t{ 0 }, obs);
+        T::serialize(data, obs);
+        const std::size_t length = obs.position() - lengthPosition - sizeof(std::size_t);
+        uint8_t encoded[sizeof(std::size_t)];
+        std::memcpy(encoded, &length, sizeof(std::size_t));
+        obs.patch(lengthPosition, encoded, sizeof(std::size_t));
+    }
+    else {
+        T::serialize(data, obs);
+    }
+}
 template<typename T> requires Serializable<T> void serialize(const T& data, OutByteStream& obs) noexcept {
-    T::serialize(data, obs);
+    if constexpr (Cacheable<T>) {
+        if (SerializationCache* cache = obs.cache()) {
+            const uint64_t key = T::cacheKey(data);
+            if (const SerializationCache::Bytes bytes = cache->find<T>(key)) {
+                obs.pushBytes(bytes->data(), bytes->size());
+                return;
+            }
+            OutByteStream encoded;
+            encoded.setCache(cache);
+            serializeValue(data, encoded);
+            if (!encoded.sharedObjectIds().empty()) {
+                // Shared object ids are numbered per stream, such an encoding cannot be reused
+                serializeValue(data, obs);
+                return;
+            }
+            obs.pushBytes(encoded.buffer().data(), encoded.buffer().size());
+            cache->insert<T>(key, encoded.releaseBuffer());
+            return;
+        }
+    }
+    serializeValue(data, obs);
+}
+
+// Writes a sequence of unknown length one element at a time.
+// The count is reserved up front and patched in by finish(), so the output reads back as a std::vector<T>
+// (or as a set, or as a map when T is a std::pair) without materializing the elements first.
+template<typename T> class SequenceWriter {
+    OutByteStream& obs;
+    const std::size_t countPosition;
+    std::size_t count = 0;
+    bool finished = false;
+public:
+    explicit SequenceWriter(OutByteStream& obs) noexcept : obs{ obs }, countPosition{ obs.position() } {
+        serialize(std::size_t{ 0 }, obs);
+    }
+    SequenceWriter(const SequenceWriter&) = delete;
+    SequenceWriter& operator=(const SequenceWriter&) = delete;
+    ~SequenceWriter() {
+        finish();
+    }
+    void push(const T& elem) noexcept {
+        assert(!finished);
+        serialize(elem, obs);
+        count++;
+    }
+    template<typename R> void pushRange(R&& range) noexcept {
+        for (const auto& elem : range) {
+            push(elem);
+        }
+    }
+    std::size_t size() const noexcept {
+        return count;
+    }
+    // Writes the final count, nothing can be pushed afterwards
+    void finish() {
+        if (finished) {
+            return;
+        }
+        uint8_t encoded[sizeof(std::size_t)];
+        std::memcpy(encoded, &count, sizeof(std::size_t));
+        obs.patch(countPosition, encoded, sizeof(std::size_t));
+        finished = true;
+    }
+};
+// Bools are packed like std::vector<bool>, each word is pushed once its 64 bits are known
+template<> class SequenceWriter<bool> {
+    OutByteStream& obs;
+    const std::size_t countPosition;
+    std::size_t count = 0;
+    uint64_t word = 0;
+    bool finished = false;
+public:
+    explicit SequenceWriter(OutByteStream& obs) noexcept : obs{ obs }, countPosition{ obs.position() } {
+        serialize(std::size_t{ 0 }, obs);
+    }
+    SequenceWriter(const SequenceWriter&) = delete;
+    SequenceWriter& operator=(const SequenceWriter&) = delete;
+    ~SequenceWriter() {
+        finish();
+    }
+    void push(bool elem) noexcept {
+        assert(!finished);
+        word |= static_cast<uint64_t>(elem) << (count % BITS_PER_WORD);
+        count++;
+        if (count % BITS_PER_WORD == 0) {
+            serialize(word, obs);
+            word = 0;
+        }
+    }
+    template<typename R> void pushRange(R&& range) noexcept {
+        for (const bool elem : range) {
+            push(elem);
+        }
+    }
+    std::size_t size() const noexcept {
+        return count;
+    }
+    // Writes the last partial word and the final count, nothing can be pushed afterwards
+    void finish() {
+        if (finished) {
+            return;
+        }
+        if (count % BITS_PER_WORD != 0) {
+            serialize(word, obs);
+        }
+        uint8_t encoded[sizeof(std::size_t)];
+        std::memcpy(encoded, &count, sizeof(std::size_t));
+        obs.patch(countPosition, encoded, sizeof(std::size_t));
+        finished = true;
+    }
+};
+
+// Serializes the value returned by make() at compile time into an array stored in the binary.
+// The array is decoded at runtime with InByteStream(std::span<const std::byte>(array)), without any file I/O.
+// Only the overloads templated on the stream are available, a sorted std::vector of pairs reads back as a std::map.
+template<auto make> consteval auto serializeToArray() {
+    constexpr std::size_t size = [] {
+        FixedOutByteStream<0> counter;
+        serialize(make(), counter);
+        return counter.position();
+    }();
+    FixedOutByteStream<size> obs;
+    serialize(make(), obs);
+    std::array<std::byte, size> retval = {};
+    for (std::size_t i = 0; i < size; i++) {
+        retval[i] = static_cast<std::byte>(obs.buffer()[i]);
+    }
+    return retval;
 }
 
 #endif // !__HEADER_SERIALIZE_H_
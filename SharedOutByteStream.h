@@ -0,0 +1,149 @@
+#ifndef __HEADER_SHAREDOUTBYTESTREAM_H_
+#define __HEADER_SHAREDOUTBYTESTREAM_H_
+
+#include "ByteStreams.h"
+#include "Serialize.h"
+
+#include <atomic>
+#include <thread>
+
+// Buffered bytes a writer collects before handing them to the flusher thread
+constexpr const std::size_t SHARED_BUFFER_SIZE = 64 * 1024;
+// Buffers waiting for the flusher thread before writers block, bounds the memory when writers outrun the file
+constexpr const std::size_t SHARED_MAX_PENDING_BUFFERS = 64;
+
+// An output file that many threads can append records to.
+// Every thread encodes into its own Writer, full buffers are handed to a single flusher thread
+// through a lock-free queue. Records are never interleaved, a record is always written whole.
+// Shared objects are numbered per record, readers clear InByteStream::sharedObjectTable() before each record.
+class SharedOutByteStream {
+    struct Node {
+        Node* next = nullptr;
+        std::vector<uint8_t> bytes;
+    };
+
+    std::ofstream fout;
+    // Lock-free stack of buffers waiting to be written, the flusher takes all of them at once
+    std::atomic<Node*> pending = nullptr;
+    std::atomic<bool> stopping = false;
+    std::atomic<std::size_t> written = 0;
+    // Buffers enqueued and not yet written
+    std::atomic<std::size_t> inFlight = 0;
+    std::thread flusher;
+
+    void enqueue(std::vector<uint8_t>&& bytes) {
+        std::size_t count = inFlight.load(std::memory_order_relaxed);
+        while (true) {
+            if (count >= SHARED_MAX_PENDING_BUFFERS) {
+                // Blocks until the flusher has written a buffer
+                inFlight.wait(count, std::memory_order_relaxed);
+                count = inFlight.load(std::memory_order_relaxed);
+            }
+            else if (inFlight.compare_exchange_weak(count, count + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        Node* node = new Node{ nullptr, std::move(bytes) };
+        node->next = pending.load(std::memory_order_relaxed);
+        while (!pending.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+        pending.notify_one();
+    }
+    void run() {
+        while (true) {
+            Node* list = pending.exchange(nullptr, std::memory_order_acquire);
+            if (list == nullptr) {
+                if (stopping.load(std::memory_order_acquire)) {
+                    break;
+                }
+                pending.wait(nullptr, std::memory_order_acquire);
+                continue;
+            }
+            // The stack is newest first, reverse it so each writer's buffers stay in order
+            Node* ordered = nullptr;
+            while (list != nullptr) {
+                Node* next = list->next;
+                list->next = ordered;
+                ordered = list;
+                list = next;
+            }
+            while (ordered != nullptr) {
+                Node* next = ordered->next;
+                fout.write(reinterpret_cast<const char*>(ordered->bytes.data()), ordered->bytes.size());
+                written.fetch_add(ordered->bytes.size(), std::memory_order_relaxed);
+                delete ordered;
+                ordered = next;
+                inFlight.fetch_sub(1, std::memory_order_relaxed);
+                inFlight.notify_all();
+            }
+        }
+        fout.flush();
+    }
+public:
+    // Encodes records for one thread, must not be shared between threads
+    class Writer {
+        SharedOutByteStream* const shared;
+        OutByteStream obs;
+    public:
+        explicit Writer(SharedOutByteStream& shared) noexcept : shared{ &shared } {}
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+        ~Writer() {
+            flush();
+        }
+        // Appends one record made of all the values
+        template<typename... Ts> void write(const Ts&... values) noexcept {
+            (serialize(values, obs), ...);
+            endRecord();
+        }
+        // Appends one record written by encode(OutByteStream&)
+        template<typename F> void record(F&& encode) {
+            encode(obs);
+            endRecord();
+        }
+        // Hands the buffered records to the flusher thread
+        void flush() {
+            if (!obs.buffer().empty()) {
+                shared->enqueue(obs.releaseBuffer());
+            }
+        }
+    private:
+        void endRecord() {
+            // The ids of the file are not shared between writers, each record starts its own
+            obs.sharedObjectIds().clear();
+            if (obs.buffer().size() >= SHARED_BUFFER_SIZE) {
+                flush();
+            }
+        }
+    };
+
+    explicit SharedOutByteStream(const std::string& path, bool deletePath = true) {
+        if (deletePath) {
+            // Delete the file (will not fail if doesn't exist)
+            std::error_code ec;
+            std::filesystem::remove(path, ec);
+        }
+        fout.open(path, std::ios::out | std::ios::binary);
+        flusher = std::thread(&SharedOutByteStream::run, this);
+    }
+    // Every Writer must be destroyed before the stream, the remaining buffers are written before returning
+    ~SharedOutByteStream() {
+        stopping.store(true, std::memory_order_release);
+        // An empty buffer wakes the flusher even if it is about to wait
+        enqueue({});
+        flusher.join();
+        fout.close();
+    }
+    SharedOutByteStream(const SharedOutByteStream&) = delete;
+    SharedOutByteStream& operator=(const SharedOutByteStream&) = delete;
+
+    Writer writer() noexcept {
+        return Writer(*this);
+    }
+    // Bytes written to the file so far
+    std::size_t bytesWritten() const noexcept {
+        return written.load(std::memory_order_relaxed);
+    }
+};
+
+#endif // !__HEADER_SHAREDOUTBYTESTREAM_H_
@@ -0,0 +1,144 @@
+#ifndef __HEADER_SKIP_H_
+#define __HEADER_SKIP_H_
+
+#include "ByteStreams.h"
+#include "Deserialize.h"
+
+// Advances an InByteStream past a serialized value without constructing it.
+// Payloads with a fixed element size are skipped in O(1) using the length prefix.
+
+// Only specialization are allowed
+template<typename T> void skip(InByteStream& ibs) = delete;
+
+template<typename T> requires Arithmetic<T> void skip(InByteStream& ibs) {
+    ibs.skipBytes(sizeof(T));
+}
+template<> inline void skip<std::string>(InByteStream& ibs) {
+    const std::size_t size = deserialize<std::size_t>(ibs);
+    if (ibs.acceptLength(size, sizeof(char))) {
+        ibs.skipBytes(size * sizeof(char));
+    }
+}
+template<typename T> requires isVector<T> void skip(InByteStream& ibs) {
+    using B = typename T::value_type;
+    const std::size_t size = deserialize<std::size_t>(ibs);
+    if constexpr (std::same_as<B, bool>) {
+        const std::size_t wordCount = packedWordCount(size);
+        if (ibs.acceptLength(size, 0) && ibs.acceptLength(wordCount, sizeof(uint64_t))) {
+            ibs.skipBytes(wordCount * sizeof(uint64_t));
+        }
+        return;
+    }
+    const DecodeScope scope(ibs);
+    if (!scope || !ibs.acceptLength(size, minSerializedSize<B>)) {
+        return;
+    }
+    if constexpr (FixedSize<B>) {
+        ibs.skipBytes(size * fixedSerializedSize<B>);
+    }
+    else {
+        for (std::size_t i = 0; i < size && !ibs.failed(); i++) {
+            skip<B>(ibs);
+        }
+    }
+}
+template<typename T> requires isSet<T> void skip(InByteStream& ibs) {
+    using B = typename T::key_type;
+    const std::size_t size = deserialize<std::size_t>(ibs);
+    const DecodeScope scope(ibs);
+    if (!scope || !ibs.acceptLength(size, minSerializedSize<B>)) {
+        return;
+    }
+    if constexpr (FixedSize<B>) {
+        ibs.skipBytes(size * fixedSerializedSize<B>);
+    }
+    else {
+        for (std::size_t i = 0; i < size && !ibs.failed(); i++) {
+            skip<B>(ibs);
+        }
+    }
+}
+template<typename T> requires isMap<T> void skip(InByteStream& ibs) {
+    using A = typename T::key_type;
+    using B = typename T::mapped_type;
+    const std::size_t size = deserialize<std::size_t>(ibs);
+    const DecodeScope scope(ibs);
+    if (!scope || !ibs.acceptLength(size, minSerializedSize<A> + minSerializedSize<B>)) {
+        return;
+    }
+    if constexpr (FixedSize<A> && FixedSize<B>) {
+        ibs.skipBytes(size * (fixedSerializedSize<A> + fixedSerializedSize<B>));
+    }
+    else {
+        for (std::size_t i = 0; i < size && !ibs.failed(); i++) {
+            skip<A>(ibs);
+            skip<B>(ibs);
+        }
+    }
+}
+template<typename T> requires isSharedPtr<T> void skip(InByteStream& ibs) {
+    // Objects seen for the first time must still be registered for later references
+    deserialize<T>(ibs);
+}
+template<typename T> requires isUniquePtr<T> void skip(InByteStream& ibs) {
+    if (deserialize<bool>(ibs)) {
+        const DecodeScope scope(ibs);
+        if (scope) {
+            skip<typename T::element_type>(ibs);
+        }
+    }
+}
+template<typename T> requires isArray<T> || isPair<T> || isTuple<T> void skip(InByteStream& ibs) {
+    if constexpr (FixedSize<T>) {
+        ibs.skipBytes(fixedSerializedSize<T>);
+    }
+    else if constexpr (isArray<T>) {
+        for (std::size_t i = 0; i < std::tuple_size_v<T>; i++) {
+            skip<typename T::value_type>(ibs);
+        }
+    }
+    else {
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            (skip<std::tuple_element_t<I, T>>(ibs), ...);
+        }(std::make_index_sequence<std::tuple_size_v<T>>{});
+    }
+}
+template<typename T> requires isBitset<T> void skip(InByteStream& ibs) {
+    ibs.skipBytes(fixedSerializedSize<T>);
+}
+template<typename T> requires isOptional<T> void skip(InByteStream& ibs) {
+    if (deserialize<bool>(ibs)) {
+        skip<typename T::value_type>(ibs);
+    }
+}
+template<typename T> requires isVariant<T> void skip(InByteStream& ibs) {
+    using Skipper = void(*)(InByteStream&);
+    constexpr auto skippers = []<std::size_t... I>(std::index_sequence<I...>) {
+        return std::array<Skipper, sizeof...(I)>{ [](InByteStream& ibs) {
+            skip<std::variant_alternative_t<I, T>>(ibs);
+        }... };
+    }(std::make_index_sequence<std::variant_size_v<T>>{});
+    const std::size_t index = deserialize<VariantIndex<T>>(ibs);
+    if (index >= skippers.size()) {
+        ibs.fail(DecodeError::InvalidVariantIndex);
+        return;
+    }
+    skippers[index](ibs);
+}
+template<typename T> requires Deserializable<T> void skip(InByteStream& ibs) {
+    if constexpr (LengthPrefixed<T>) {
+        const std::size_t size = deserialize<std::size_t>(ibs);
+        if (ibs.acceptLength(size, 1)) {
+            ibs.skipBytes(size);
+        }
+    }
+    else if constexpr (Skippable<T>) {
+        T::skip(ibs);
+    }
+    else {
+        // No faster way for the type, construct it and throw it away
+        deserialize<T>(ibs);
+    }
+}
+
+#endif // !__HEADER_SKIP_H_
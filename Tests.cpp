@@ -3,6 +3,11 @@
 #include "ByteStreams.h"
 #include "Serialize.h"
 #include "Deserialize.h"
+#include "Skip.h"
+#include "SharedOutByteStream.h"
+#include "Delta.h"
+#include "XorCompression.h"
+#include "SerializationCache.h"
 
 
 void testIntegral_Serialize_Deserialize_2() {
@@ -683,6 +688,9 @@ public:
     bool operator==(const TestClass& rhs) const noexcept {
         return (this->a == rhs.a) && (this->b == rhs.b) && (this->c == rhs.c);
     }
+    bool operator<(const TestClass& rhs) const noexcept {
+        return std::tie(a, b, c) < std::tie(rhs.a, rhs.b, rhs.c);
+    }
 };
 
 void testClass_Serialize_Deserialize() {
@@ -697,6 +705,1065 @@ void testClass_Serialize_Deserialize() {
     }
 }
 
+class TestPrefixedClass {
+    std::string name;
+    std::vector<int> values;
+public:
+    static constexpr bool lengthPrefixed = true;
+
+    explicit TestPrefixedClass(std::string name, std::vector<int> values) noexcept : name{ name }, values{ values } {}
+    // This is the deserialization constructor
+    explicit TestPrefixedClass(InByteStream& ibs) {
+        name = deserialize<std::string>(ibs);
+        values = deserialize<std::vector<int>>(ibs);
+    }
+    static void serialize(const TestPrefixedClass& tc, OutByteStream& obs) {
+        ::serialize(tc.name, obs);
+        ::serialize(tc.values, obs);
+    }
+
+    bool operator==(const TestPrefixedClass& rhs) const noexcept {
+        return (this->name == rhs.name) && (this->values == rhs.values);
+    }
+};
+
+void testSkip() {
+    {
+        OutByteStream obs = OutByteStream();
+        serialize(std::vector<int>{ 1, 2, 3 }, obs);
+        serialize(std::string("skipped"), obs);
+        serialize(std::map<int, double>{ {1, 1.0}, {2, 2.0} }, obs);
+        serialize(42, obs);
+        InByteStream ibs = InByteStream(obs);
+        skip<std::vector<int>>(ibs);
+        skip<std::string>(ibs);
+        skip<std::map<int, double>>(ibs);
+        assert(deserialize<int>(ibs) == 42);
+        assert(ibs.isEmpty());
+    }
+    {
+        OutByteStream obs = OutByteStream();
+        const std::map<std::string, std::vector<std::string>> value = { {"a", {"b", "c"}}, {"d", {}} };
+        serialize(value, obs);
+        serialize(std::unordered_set<std::string>{ "x", "y" }, obs);
+        serialize(TestClass(1, 2, 3), obs);
+        serialize(TestPrefixedClass("prefixed", { 4, 5, 6 }), obs);
+        serialize(TestPrefixedClass("kept", { 7 }), obs);
+        InByteStream ibs = InByteStream(obs);
+        skip<std::map<std::string, std::vector<std::string>>>(ibs);
+        skip<std::unordered_set<std::string>>(ibs);
+        skip<TestClass>(ibs);
+        skip<TestPrefixedClass>(ibs);
+        assert(deserialize<TestPrefixedClass>(ibs) == TestPrefixedClass("kept", { 7 }));
+        assert(ibs.isEmpty());
+    }
+    {
+        // Skipping past the buffered bytes seeks the file
+        std::vector<int64_t> large(10'000, 7);
+        {
+            OutByteStream obs = OutByteStream("./testSkip.bin");
+            serialize(large, obs);
+            serialize(std::string("after"), obs);
+            obs.writeToFile();
+        }
+        InByteStream ibs = InByteStream("./testSkip.bin");
+        skip<std::vector<int64_t>>(ibs);
+        assert(deserialize<std::string>(ibs) == "after");
+    }
+    {
+        // The payload must match its length prefix, trailing bytes are skipped
+        OutByteStream payload = OutByteStream();
+        serialize(std::string("prefixed"), payload);
+        serialize(std::vector<int>{ 1 }, payload);
+        serialize(99, payload);
+        const std::vector<uint8_t> bytes = payload.buffer();
+        OutByteStream obs = OutByteStream();
+        serialize(bytes.size(), obs);
+        obs.pushBytes(bytes.data(), bytes.size());
+        serialize(7, obs);
+        // Too short for the payload
+        serialize(bytes.size() - 2 * sizeof(int), obs);
+        obs.pushBytes(bytes.data(), bytes.size());
+        InByteStream ibs = InByteStream(obs);
+        assert(deserialize<TestPrefixedClass>(ibs) == TestPrefixedClass("prefixed", { 1 }));
+        assert(deserialize<int>(ibs) == 7);
+        deserialize<TestPrefixedClass>(ibs);
+        assert(ibs.error() == DecodeError::LengthMismatch);
+    }
+}
+
+void testStreamStats() {
+    if constexpr (!STREAM_STATS_ENABLED) {
+        return;
+    }
+    {
+        OutByteStream obs = OutByteStream();
+        serialize(std::vector<int32_t>{ 1, 2, 3 }, obs);
+        assert(obs.stats().bytes == sizeof(std::size_t) + 3 * sizeof(int32_t));
+        assert(obs.stats().flushes == 0);
+        InByteStream ibs = InByteStream(obs);
+        assert(ibs.stats().bytes == 0);
+        deserialize<std::size_t>(ibs);
+        assert(ibs.stats().bytes == sizeof(std::size_t));
+    }
+    {
+        const std::vector<int64_t> value(2 * BUFFER_REFILL_SIZE, 1);
+        std::size_t flushHookCalls = 0;
+        {
+            OutByteStream obs = OutByteStream("./testStats.bin");
+            obs.onFlush([&flushHookCalls](const StreamStats&) { flushHookCalls++; });
+            serialize(value, obs);
+            obs.writeToFile();
+            const StreamStats stats = obs.stats();
+            assert(stats.bytes == sizeof(std::size_t) + value.size() * sizeof(int64_t));
+            assert(stats.flushes > 1);
+            assert(stats.flushes == flushHookCalls);
+            assert(stats.ioCalls == stats.flushes);
+        }
+        std::size_t refillHookCalls = 0;
+        InByteStream ibs = InByteStream("./testStats.bin");
+        ibs.onRefill([&refillHookCalls](const StreamStats&) { refillHookCalls++; });
+        assert(deserialize<std::vector<int64_t>>(ibs) == value);
+        const StreamStats stats = ibs.stats();
+        assert(stats.bytes == sizeof(std::size_t) + value.size() * sizeof(int64_t));
+        // The constructor fills the first buffer before the hook is set, the rest of the vector is read at once
+        assert(stats.refills == refillHookCalls + 1);
+        assert(stats.refills == 2);
+        assert(stats.largestValue == value.size() * sizeof(int64_t));
+        assert(stats.ioTime.count() > 0);
+    }
+}
+
+class TestLargeClass {
+    std::array<uint8_t, 4096> data;
+public:
+    // This is the deserialization constructor
+    explicit TestLargeClass(InByteStream& ibs) {
+        data = deserialize<std::array<uint8_t, 4096>>(ibs);
+    }
+    static void serialize(const TestLargeClass& tc, OutByteStream& obs) {
+        ::serialize(tc.data, obs);
+    }
+};
+
+void testDecodeLimits() {
+    {
+        OutByteStream obs = OutByteStream();
+        serialize(std::vector<int>{ 1, 2, 3 }, obs);
+        InByteStream ibs = InByteStream(obs);
+        const auto result = tryDeserialize<std::vector<int>>(ibs);
+        assert(result.hasValue());
+        assert(*result == std::vector<int>({ 1, 2, 3 }));
+    }
+    {
+        // Corrupt length prefix is rejected before allocating
+        OutByteStream obs = OutByteStream();
+        serialize(std::size_t{ 1 } << 60, obs);
+        serialize(1, obs);
+        InByteStream ibs = InByteStream(obs);
+        const auto result = tryDeserialize<std::vector<std::vector<int>>>(ibs);
+        assert(!result);
+        assert(result.error() == DecodeError::LengthExceedsInput);
+    }
+    {
+        OutByteStream obs = OutByteStream();
+        serialize(std::size_t{ 1 } << 60, obs);
+        InByteStream ibs = InByteStream(obs);
+        assert(tryDeserialize<std::string>(ibs).error() == DecodeError::LengthExceedsInput);
+    }
+    {
+        // User types have no known minimum size, the corrupt length fails on the first missing element
+        for (const std::size_t size : { std::size_t{ 1 } << 60, std::size_t{ 50'000'000 } }) {
+            OutByteStream obs = OutByteStream();
+            serialize(size, obs);
+            serialize(TestClass(1, 2, 3), obs);
+            InByteStream ibs = InByteStream(obs);
+            assert(tryDeserialize<std::vector<TestClass>>(ibs).error() == DecodeError::UnexpectedEnd);
+        }
+        OutByteStream obs = OutByteStream();
+        serialize(std::size_t{ 1 } << 60, obs);
+        serialize(TestClass(1, 2, 3), obs);
+        InByteStream ibs = InByteStream(obs);
+        assert(tryDeserialize<std::set<TestClass>>(ibs).error() == DecodeError::UnexpectedEnd);
+    }
+    {
+        // Elements much larger than the input left cannot be reserved for
+        OutByteStream obs = OutByteStream();
+        serialize(std::size_t{ 1 } << 60, obs);
+        serialize(std::vector<uint8_t>(4 * 1024 * 1024), obs);
+        InByteStream ibs = InByteStream(obs);
+        ibs.setLimits(DecodeLimits{ .maxBytes = 8 * 1024 * 1024 });
+        assert(tryDeserialize<std::vector<TestLargeClass>>(ibs).error() == DecodeError::UnexpectedEnd);
+    }
+    {
+        // Truncated input
+        OutByteStream obs = OutByteStream();
+        serialize(uint16_t{ 1 }, obs);
+        InByteStream ibs = InByteStream(obs);
+        assert(tryDeserialize<uint32_t>(ibs).error() == DecodeError::UnexpectedEnd);
+    }
+    {
+        OutByteStream obs = OutByteStream();
+        serialize(std::map<int, int>{ {1, 1}, {2, 2}, {3, 3} }, obs);
+        InByteStream ibs = InByteStream(obs);
+        ibs.setLimits(DecodeLimits{ .maxElements = 2 });
+        const auto result = tryDeserialize<std::map<int, int>>(ibs);
+        assert(result.error() == DecodeError::TooManyElements);
+    }
+    {
+        OutByteStream obs = OutByteStream();
+        serialize(std::vector<std::vector<std::vector<int>>>{ { { 1 } } }, obs);
+        InByteStream ibs = InByteStream(obs);
+        ibs.setLimits(DecodeLimits{ .maxDepth = 2 });
+        assert(tryDeserialize<std::vector<std::vector<std::vector<int>>>>(ibs).error() == DecodeError::TooDeep);
+    }
+    {
+        OutByteStream obs = OutByteStream();
+        serialize(std::vector<int64_t>(100, 1), obs);
+        InByteStream ibs = InByteStream(obs);
+        ibs.setLimits(DecodeLimits{ .maxBytes = 256 });
+        assert(tryDeserialize<std::vector<int64_t>>(ibs).error() == DecodeError::TooManyBytes);
+    }
+    {
+        // A truncated file
+        {
+            OutByteStream obs = OutByteStream("./testLimits.bin");
+            serialize(std::size_t{ 100'000 }, obs);
+            serialize(std::vector<int>(1000, 1), obs);
+            obs.writeToFile();
+        }
+        InByteStream ibs = InByteStream("./testLimits.bin");
+        assert(tryDeserialize<std::vector<int>>(ibs).error() == DecodeError::LengthExceedsInput);
+    }
+    {
+        // Large values read after a failure are zeros, not the file contents
+        {
+            OutByteStream obs = OutByteStream("./testLimits.bin");
+            std::array<uint8_t, 8192> ones;
+            ones.fill(1);
+            serialize(ones, obs);
+            obs.writeToFile();
+        }
+        InByteStream ibs = InByteStream("./testLimits.bin");
+        ibs.fail(DecodeError::TooDeep);
+        assert((deserialize<std::array<uint8_t, 8192>>(ibs) == std::array<uint8_t, 8192>{}));
+        assert(ibs.error() == DecodeError::TooDeep);
+    }
+}
+
+void testSharedOutByteStream() {
+    constexpr int threadCount = 8;
+    constexpr int recordCount = 2000;
+    {
+        SharedOutByteStream shared = SharedOutByteStream("./testShared.bin");
+        std::vector<std::thread> threads;
+        for (int t = 0; t < threadCount; t++) {
+            threads.emplace_back([&shared, t]() {
+                SharedOutByteStream::Writer writer = shared.writer();
+                for (int r = 0; r < recordCount; r++) {
+                    // A record is the thread id, the record number and a payload filled with the thread id
+                    writer.write(t, r, std::vector<int>(r % 50, t));
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+    InByteStream ibs = InByteStream("./testShared.bin");
+    std::vector<int> nextRecord(threadCount, 0);
+    for (int i = 0; i < threadCount * recordCount; i++) {
+        const int t = deserialize<int>(ibs);
+        const int r = deserialize<int>(ibs);
+        const auto payload = deserialize<std::vector<int>>(ibs);
+        assert(t >= 0 && t < threadCount);
+        assert(r == nextRecord[t]);
+        assert(payload == std::vector<int>(r % 50, t));
+        nextRecord[t]++;
+    }
+    assert(ibs.remaining() == 0);
+    {
+        // Each writer numbers its shared objects per record
+        {
+            SharedOutByteStream shared = SharedOutByteStream("./testShared.bin");
+            SharedOutByteStream::Writer first = shared.writer();
+            SharedOutByteStream::Writer second = shared.writer();
+            const auto value = std::make_shared<int>(111);
+            first.write(value);
+            first.flush();
+            second.write(std::make_shared<int>(222));
+            second.flush();
+            first.write(value, value);
+            first.flush();
+        }
+        InByteStream sharedIbs = InByteStream("./testShared.bin");
+        assert(*deserialize<std::shared_ptr<int>>(sharedIbs) == 111);
+        sharedIbs.sharedObjectTable().clear();
+        assert(*deserialize<std::shared_ptr<int>>(sharedIbs) == 222);
+        sharedIbs.sharedObjectTable().clear();
+        const auto a = deserialize<std::shared_ptr<int>>(sharedIbs);
+        const auto b = deserialize<std::shared_ptr<int>>(sharedIbs);
+        assert(*a == 111 && a == b);
+        assert(sharedIbs.remaining() == 0);
+    }
+}
+
+class TestNode {
+public:
+    int value;
+    std::vector<std::shared_ptr<TestNode>> children;
+
+    explicit TestNode(int value) noexcept : value{ value } {}
+    // This is the deserialization constructor
+    explicit TestNode(InByteStream& ibs) {
+        value = deserialize<int>(ibs);
+        children = deserialize<std::vector<std::shared_ptr<TestNode>>>(ibs);
+    }
+    static void serialize(const TestNode& node, OutByteStream& obs) {
+        ::serialize(node.value, obs);
+        ::serialize(node.children, obs);
+    }
+};
+
+class TestList {
+public:
+    int value;
+    std::unique_ptr<TestList> next;
+
+    explicit TestList(int value) noexcept : value{ value } {}
+    // This is the deserialization constructor
+    explicit TestList(InByteStream& ibs) {
+        value = deserialize<int>(ibs);
+        next = deserialize<std::unique_ptr<TestList>>(ibs);
+    }
+    static void serialize(const TestList& list, OutByteStream& obs) {
+        ::serialize(list.value, obs);
+        ::serialize(list.next, obs);
+    }
+};
+
+void testPointer_Serialize_Deserialize() {
+    {
+        // Shared subtrees are written once and decoded to the same object
+        auto shared = std::make_shared<TestNode>(2);
+        shared->children.push_back(std::make_shared<TestNode>(3));
+        auto root = std::make_shared<TestNode>(1);
+        for (int i = 0; i < 100; i++) {
+            root->children.push_back(shared);
+        }
+        root->children.push_back(nullptr);
+        OutByteStream obs = OutByteStream();
+        serialize(root, obs);
+        // Every reference after the first is a single id
+        OutByteStream once = OutByteStream();
+        serialize(*shared, once);
+        assert(obs.buffer().size() < once.buffer().size() + 101 * sizeof(std::size_t) + 64);
+        InByteStream ibs = InByteStream(obs);
+        const auto i = deserialize<std::shared_ptr<TestNode>>(ibs);
+        assert(i->value == 1);
+        assert(i->children.size() == 101);
+        assert(i->children[0]->value == 2);
+        assert(i->children[0]->children[0]->value == 3);
+        assert(i->children[0] == i->children[99]);
+        assert(i->children[100] == nullptr);
+        assert(ibs.isEmpty());
+    }
+    {
+        // Cycles resolve to the object being decoded
+        auto root = std::make_shared<TestNode>(1);
+        root->children.push_back(std::make_shared<TestNode>(2));
+        root->children[0]->children.push_back(root);
+        OutByteStream obs = OutByteStream();
+        serialize(root, obs);
+        root->children[0]->children.clear();
+        InByteStream ibs = InByteStream(obs);
+        const auto i = deserialize<std::shared_ptr<TestNode>>(ibs);
+        assert(i->children[0]->children[0] == i);
+        i->children[0]->children.clear();
+    }
+    {
+        OutByteStream obs = OutByteStream();
+        const auto value = std::make_shared<std::vector<int>>(std::vector<int>{ 1, 2, 3 });
+        serialize(std::vector<std::shared_ptr<std::vector<int>>>{ value, value }, obs);
+        serialize(std::size_t{ 5 }, obs); // Reference to an object that was never written
+        InByteStream ibs = InByteStream(obs);
+        const auto i = deserialize<std::vector<std::shared_ptr<std::vector<int>>>>(ibs);
+        assert(*i[0] == *value);
+        assert(i[0] == i[1]);
+        assert(tryDeserialize<std::shared_ptr<int>>(ibs).error() == DecodeError::InvalidReference);
+    }
+    {
+        // A back-reference must refer to an object of the same type
+        OutByteStream obs = OutByteStream();
+        serialize(std::make_shared<std::string>("shared"), obs);
+        serialize(std::size_t{ 1 }, obs);
+        InByteStream ibs = InByteStream(obs);
+        assert(*deserialize<std::shared_ptr<std::string>>(ibs) == "shared");
+        const auto result = tryDeserialize<std::shared_ptr<std::vector<double>>>(ibs);
+        assert(!result);
+        assert(result.error() == DecodeError::InvalidReference);
+    }
+    {
+        OutByteStream obs = OutByteStream();
+        serialize(std::make_unique<std::string>("unique"), obs);
+        serialize(std::unique_ptr<int>(), obs);
+        InByteStream ibs = InByteStream(obs);
+        assert(*deserialize<std::unique_ptr<std::string>>(ibs) == "unique");
+        assert(deserialize<std::unique_ptr<int>>(ibs) == nullptr);
+        assert(ibs.isEmpty());
+    }
+    {
+        // A crafted unique_ptr chain far deeper than the stack allows is bounded by maxDepth
+        OutByteStream obs = OutByteStream();
+        for (int i = 0; i < 1'000'000; i++) {
+            serialize(i, obs);
+            serialize(true, obs);
+        }
+        const auto bytes = std::as_bytes(std::span<const uint8_t>(obs.buffer()));
+        InByteStream ibs = InByteStream(bytes);
+        ibs.setLimits(DecodeLimits{ .maxDepth = 16 });
+        assert(tryDeserialize<TestList>(ibs).error() == DecodeError::TooDeep);
+        InByteStream skipped = InByteStream(bytes);
+        skipped.setLimits(DecodeLimits{ .maxDepth = 16 });
+        skip<TestList>(skipped);
+        assert(skipped.error() == DecodeError::TooDeep);
+    }
+    {
+        // A freed object's address reused by a new one is not a reference to the old one
+        OutByteStream obs = OutByteStream();
+        for (int i = 1; i <= 3; i++) {
+            serialize(std::make_shared<int>(i), obs);
+        }
+        InByteStream ibs = InByteStream(obs);
+        for (int i = 1; i <= 3; i++) {
+            assert(*deserialize<std::shared_ptr<int>>(ibs) == i);
+        }
+        assert(ibs.isEmpty());
+    }
+    {
+        // A member aliasing the address of its owner is a different object
+        const auto pair = std::make_shared<std::pair<int, int>>(1, 2);
+        const auto first = std::shared_ptr<int>(pair, &pair->first);
+        OutByteStream obs = OutByteStream();
+        serialize(pair, obs);
+        serialize(first, obs);
+        InByteStream ibs = InByteStream(obs);
+        assert((*deserialize<std::shared_ptr<std::pair<int, int>>>(ibs) == std::pair<int, int>(1, 2)));
+        assert(*deserialize<std::shared_ptr<int>>(ibs) == 1);
+        assert(ibs.isEmpty());
+    }
+}
+
+void testFixedComposite_Serialize_Deserialize() {
+    static_assert(fixedSerializedSize<std::array<float, 16>> == 16 * sizeof(float));
+    static_assert(fixedSerializedSize<std::pair<int32_t, double>> == sizeof(int32_t) + sizeof(double));
+    static_assert(fixedSerializedSize<std::tuple<uint8_t, int16_t, std::array<int32_t, 2>>> == 1 + 2 + 8);
+    static_assert(!FixedSize<std::pair<int, std::string>>);
+    {
+        OutByteStream obs = OutByteStream();
+        const std::array<float, 16> value = { 1.0f, -2.0f, 3.5f, 0.0f, -0.0f, 1e30f };
+        serialize(value, obs);
+        // No length prefix
+        assert(obs.buffer().size() == sizeof(value));
+        InByteStream ibs = InByteStream(obs);
+        assert((deserialize<std::array<float, 16>>(ibs)) == value);
+        assert(ibs.isEmpty());
+    }
+    {
+        OutByteStream obs = OutByteStream();
+        const std::tuple<uint8_t, int16_t, std::array<int32_t, 2>, std::pair<double, bool>> value = { 1, -2, { 3, 4 }, { 5.5, true } };
+        serialize(value, obs);
+        assert(obs.buffer().size() == 1 + 2 + 8 + 8 + 1);
+        InByteStream ibs = InByteStream(obs);
+        const auto i = deserialize<std::tuple<uint8_t, int16_t, std::array<int32_t, 2>, std::pair<double, bool>>>(ibs);
+        assert(i == value);
+        assert(ibs.isEmpty());
+    }
+    {
+        OutByteStream obs = OutByteStream();
+        const std::pair<std::string, std::vector<int>> pair = { "pair", { 1, 2 } };
+        const std::array<std::string, 3> strings = { "a", "bb", "" };
+        const std::vector<std::array<int64_t, 4>> arrays = { { 1, 2, 3, 4 }, { 5, 6, 7, 8 } };
+        serialize(pair, obs);
+        serialize(strings, obs);
+        serialize(arrays, obs);
+        InByteStream ibs = InByteStream(obs);
+        assert((deserialize<std::pair<std::string, std::vector<int>>>(ibs)) == pair);
+        assert((deserialize<std::array<std::string, 3>>(ibs)) == strings);
+        assert((deserialize<std::vector<std::array<int64_t, 4>>>(ibs)) == arrays);
+        assert(ibs.isEmpty());
+    }
+    {
+        OutByteStream obs = OutByteStream();
+        const std::optional<std::string> some = "some";
+        const std::optional<int> none = std::nullopt;
+        serialize(some, obs);
+        serialize(none, obs);
+        InByteStream ibs = InByteStream(obs);
+        assert(deserialize<std::optional<std::string>>(ibs) == some);
+        assert(deserialize<std::optional<int>>(ibs) == none);
+        assert(ibs.isEmpty());
+    }
+    {
+        using Variant = std::variant<int, std::string, std::vector<double>>;
+        OutByteStream obs = OutByteStream();
+        const std::vector<Variant> value = { 1, std::string("two"), std::vector<double>{ 3.0 } };
+        serialize(value, obs);
+        InByteStream ibs = InByteStream(obs);
+        assert(deserialize<std::vector<Variant>>(ibs) == value);
+        assert(ibs.isEmpty());
+    }
+    {
+        OutByteStream obs = OutByteStream();
+        serialize(std::pair<int, std::string>{ 1, "skipped" }, obs);
+        serialize(std::array<double, 8>{}, obs);
+        serialize(std::variant<int, std::string>{ "skipped" }, obs);
+        serialize(std::optional<std::string>{ "skipped" }, obs);
+        serialize(uint8_t{ 9 }, obs);
+        serialize(uint8_t{ 7 }, obs); // Not a valid index for the variant
+        InByteStream ibs = InByteStream(obs);
+        skip<std::pair<int, std::string>>(ibs);
+        skip<std::array<double, 8>>(ibs);
+        skip<std::variant<int, std::string>>(ibs);
+        skip<std::optional<std::string>>(ibs);
+        assert(deserialize<uint8_t>(ibs) == 9);
+        const auto result = tryDeserialize<std::variant<int, std::string>>(ibs);
+        assert(result.error() == DecodeError::InvalidVariantIndex);
+    }
+    {
+        // The index of a valueless variant cannot be taken by an alternative
+        using Variant255 = decltype([]<std::size_t... I>(std::index_sequence<I...>) {
+            return std::variant<std::integral_constant<std::size_t, I>...>{};
+        }(std::make_index_sequence<255>()));
+        using Variant256 = decltype([]<std::size_t... I>(std::index_sequence<I...>) {
+            return std::variant<std::integral_constant<std::size_t, I>...>{};
+        }(std::make_index_sequence<256>()));
+        static_assert(std::is_same_v<VariantIndex<Variant255>, uint8_t>);
+        static_assert(std::is_same_v<VariantIndex<Variant256>, uint32_t>);
+    }
+}
+
+void testSequenceWriter() {
+    {
+        OutByteStream obs = OutByteStream();
+        {
+            SequenceWriter<int> writer = SequenceWriter<int>(obs);
+            for (int i = 0; i < 10; i++) {
+                if (i % 3 == 0) {
+                    writer.push(i);
+                }
+            }
+            assert(writer.size() == 4);
+        }
+        serialize(std::string("after"), obs);
+        InByteStream ibs = InByteStream(obs);
+        assert(deserialize<std::vector<int>>(ibs) == std::vector<int>({ 0, 3, 6, 9 }));
+        assert(deserialize<std::string>(ibs) == "after");
+        assert(ibs.isEmpty());
+    }
+    {
+        // Nested sequences and pairs read back as a map
+        OutByteStream obs = OutByteStream();
+        SequenceWriter<std::pair<std::string, std::vector<int>>> writer = SequenceWriter<std::pair<std::string, std::vector<int>>>(obs);
+        writer.push({ "a", { 1 } });
+        writer.push({ "b", {} });
+        writer.finish();
+        InByteStream ibs = InByteStream(obs);
+        const auto i = deserialize<std::map<std::string, std::vector<int>>>(ibs);
+        assert(i.size() == 2);
+        assert(i.at("a") == std::vector<int>({ 1 }));
+        assert(i.at("b").empty());
+    }
+    {
+        // The count has already been flushed to the file when it is patched
+        constexpr int limit = 100'000;
+        {
+            OutByteStream obs = OutByteStream("./testSequence.bin");
+            SequenceWriter<std::string> writer = SequenceWriter<std::string>(obs);
+            for (int i = 0; i < limit; i++) {
+                writer.push(std::to_string(i));
+            }
+            writer.finish();
+            serialize(-1, obs);
+            obs.writeToFile();
+        }
+        InByteStream ibs = InByteStream("./testSequence.bin");
+        const auto i = deserialize<std::vector<std::string>>(ibs);
+        assert(i.size() == limit);
+        assert(i.back() == std::to_string(limit - 1));
+        assert(deserialize<int>(ibs) == -1);
+    }
+    {
+        // Bools are packed and read back as a std::vector<bool>
+        for (const std::size_t size : { 0, 10, 64, 130 }) {
+            std::vector<bool> expected;
+            OutByteStream obs = OutByteStream();
+            {
+                SequenceWriter<bool> writer = SequenceWriter<bool>(obs);
+                for (std::size_t i = 0; i < size; i++) {
+                    writer.push(i % 2 == 0);
+                    expected.push_back(i % 2 == 0);
+                }
+            }
+            OutByteStream packed = OutByteStream();
+            serialize(expected, packed);
+            assert(obs.buffer() == packed.buffer());
+            InByteStream ibs = InByteStream(obs);
+            assert(deserialize<std::vector<bool>>(ibs) == expected);
+            assert(ibs.isEmpty());
+        }
+    }
+}
+
+void testDelta() {
+    std::unordered_map<int, std::string> base;
+    for (int i = 0; i < 1000; i++) {
+        base.insert({ i, std::to_string(i) });
+    }
+    {
+        std::unordered_map<int, std::string> current = base;
+        current[1] = "updated";
+        current[5000] = "inserted";
+        current.erase(2);
+        OutByteStream obs = OutByteStream();
+        serializeDelta(base, current, obs);
+        OutByteStream full = OutByteStream();
+        serialize(current, full);
+        assert(obs.buffer().size() < full.buffer().size() / 10);
+        InByteStream ibs = InByteStream(obs);
+        std::unordered_map<int, std::string> state = base;
+        applyDelta(state, ibs);
+        assert(state == current);
+        assert(ibs.isEmpty());
+    }
+    {
+        // A chain of deltas from dirty keys, compacted into a new base
+        std::map<int, std::string> state = std::map<int, std::string>(base.begin(), base.end());
+        {
+            OutByteStream obs = OutByteStream("./testDeltaBase.bin");
+            serialize(state, obs);
+            obs.writeToFile();
+        }
+        state[3] = "three";
+        state.erase(4);
+        {
+            OutByteStream obs = OutByteStream("./testDelta1.bin");
+            serializeDirty(state, std::vector<int>{ 3, 4 }, obs);
+            obs.writeToFile();
+        }
+        state[4] = "four";
+        state[-1] = "minus one";
+        {
+            OutByteStream obs = OutByteStream("./testDelta2.bin");
+            serializeDirty(state, std::set<int>{ 4, -1 }, obs);
+            obs.writeToFile();
+        }
+        const std::vector<std::string> deltas = { "./testDelta1.bin", "./testDelta2.bin" };
+        const auto loaded = loadSnapshot<std::map<int, std::string>>("./testDeltaBase.bin", deltas);
+        assert(loaded.hasValue());
+        assert(*loaded == state);
+        const DecodeError error = compactSnapshot<std::map<int, std::string>>("./testDeltaBase.bin", deltas, "./testDeltaCompacted.bin");
+        assert(error == DecodeError::None);
+        InByteStream ibs = InByteStream("./testDeltaCompacted.bin");
+        const auto compacted = deserialize<std::map<int, std::string>>(ibs);
+        assert(compacted == state);
+    }
+    {
+        OutByteStream obs = OutByteStream();
+        serialize(std::size_t{ 1 }, obs);
+        serialize(uint8_t{ 42 }, obs);
+        serialize(1, obs);
+        InByteStream ibs = InByteStream(obs);
+        std::map<int, int> state;
+        applyDelta(state, ibs);
+        assert(ibs.error() == DecodeError::InvalidDeltaRecord);
+    }
+}
+
+void testReadAhead() {
+    std::vector<std::string> strings;
+    for (int i = 0; i < 10'000; i++) {
+        strings.push_back(std::to_string(i));
+    }
+    const std::vector<int64_t> large(5'000, 3);
+    {
+        OutByteStream obs = OutByteStream("./testReadAhead.bin");
+        serialize(strings, obs);
+        serialize(large, obs);
+        serialize(large, obs);
+        serialize(std::string("end"), obs);
+        obs.writeToFile();
+    }
+    {
+        InByteStream ibs = InByteStream("./testReadAhead.bin", ReadAhead{ .buffers = 3, .bufferSize = 1000 });
+        assert(deserialize<std::vector<std::string>>(ibs) == strings);
+        assert(deserialize<std::vector<int64_t>>(ibs) == large);
+        // Skipping drops whole prefetched buffers
+        skip<std::vector<int64_t>>(ibs);
+        assert(deserialize<std::string>(ibs) == "end");
+        assert(ibs.isEmpty());
+        assert(tryDeserialize<int>(ibs).error() == DecodeError::UnexpectedEnd);
+    }
+    {
+        // The prefetcher stops when the stream is destroyed before the end of the file
+        InByteStream ibs = InByteStream("./testReadAhead.bin", ReadAhead{ .buffers = 2, .bufferSize = 64 });
+        assert(deserialize<std::size_t>(ibs) == strings.size());
+    }
+}
+
+template<typename F> bool sameBits(const std::vector<F>& a, const std::vector<F>& b) {
+    return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(F)) == 0;
+}
+
+void testXorCompression() {
+    {
+        // Slowly changing series compress well
+        std::vector<double> value;
+        double current = 100.0;
+        for (int i = 0; i < 10'000; i++) {
+            current += (i % 7 == 0) ? 0.25 : 0.0;
+            value.push_back(current);
+        }
+        OutByteStream obs = OutByteStream();
+        serializeXor(value, obs);
+        assert(obs.buffer().size() < value.size() * sizeof(double) / 8);
+        InByteStream ibs = InByteStream(obs);
+        assert(sameBits(deserializeXor<std::vector<double>>(ibs), value));
+        assert(ibs.isEmpty());
+    }
+    {
+        // Special values keep their exact bits
+        const std::vector<double> value = {
+            0.0, -0.0, std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(),
+            std::numeric_limits<double>::quiet_NaN(), std::bit_cast<double>(uint64_t{ 0x7FF0000000000ABCull }),
+            -std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::denorm_min(),
+            std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest(), std::numeric_limits<double>::epsilon(), 1.0, 1.0 };
+        const std::vector<float> floats = {
+            0.0f, -0.0f, std::numeric_limits<float>::infinity(), std::bit_cast<float>(uint32_t{ 0x7FC00123u }),
+            std::numeric_limits<float>::denorm_min(), std::numeric_limits<float>::max(), 3.14f, 3.14f, -2.5f };
+        OutByteStream obs = OutByteStream();
+        serializeXor(value, obs);
+        serializeXor(floats, obs);
+        serializeXor(std::vector<double>{}, obs);
+        serializeXor(std::vector<float>{ 1.5f }, obs);
+        serialize(7, obs);
+        InByteStream ibs = InByteStream(obs);
+        assert(sameBits(deserializeXor<std::vector<double>>(ibs), value));
+        assert(sameBits(deserializeXor<std::vector<float>>(ibs), floats));
+        assert(deserializeXor<std::vector<double>>(ibs).empty());
+        skipXor<std::vector<float>>(ibs);
+        assert(deserialize<int>(ibs) == 7);
+        assert(ibs.isEmpty());
+    }
+    {
+        // The count does not match the bit stream
+        OutByteStream obs = OutByteStream();
+        serialize(std::size_t{ 1000 }, obs);
+        serialize(std::size_t{ 8 }, obs);
+        serialize(1.0, obs);
+        InByteStream ibs = InByteStream(obs);
+        assert(deserializeXor<std::vector<double>>(ibs).empty());
+        assert(ibs.error() == DecodeError::InvalidCompressedData);
+    }
+    {
+        // Too short for the first value
+        OutByteStream obs = OutByteStream();
+        serialize(std::size_t{ 1 }, obs);
+        serialize(std::size_t{ 0 }, obs);
+        InByteStream ibs = InByteStream(obs);
+        assert(deserializeXor<std::vector<double>>(ibs).empty());
+        assert(ibs.error() == DecodeError::InvalidCompressedData);
+    }
+    {
+        // A new window of 64 meaningful bits at the very end of the stream
+        std::vector<uint8_t> encoded(9, 0);
+        encoded[8] = 0b1111'1111;
+        OutByteStream obs = OutByteStream();
+        serialize(std::size_t{ 2 }, obs);
+        serialize(encoded.size(), obs);
+        obs.pushBytes(encoded.data(), encoded.size());
+        InByteStream ibs = InByteStream(obs);
+        assert(deserializeXor<std::vector<double>>(ibs).empty());
+        assert(ibs.error() == DecodeError::InvalidCompressedData);
+    }
+}
+
+void testPackedBool_Serialize_Deserialize() {
+    {
+        // Sizes around the word boundaries
+        for (const std::size_t size : { 0, 1, 63, 64, 65, 128, 1000, 100'003 }) {
+            std::vector<bool> value(size);
+            for (std::size_t i = 0; i < size; i++) {
+                value[i] = (i * 7919) % 3 == 0;
+            }
+            OutByteStream obs = OutByteStream();
+            serialize(value, obs);
+            assert(obs.buffer().size() == sizeof(std::size_t) + packedWordCount(size) * sizeof(uint64_t));
+            InByteStream ibs = InByteStream(obs);
+            assert(deserialize<std::vector<bool>>(ibs) == value);
+            assert(ibs.isEmpty());
+        }
+    }
+    {
+        // The bits are eight times smaller than one byte per bool
+        const std::vector<bool> value(80'000, true);
+        OutByteStream obs = OutByteStream();
+        serialize(value, obs);
+        assert(obs.buffer().size() == sizeof(std::size_t) + value.size() / 8);
+    }
+    {
+        std::bitset<1> one;
+        one.set(0);
+        std::bitset<64> word;
+        word.set(0).set(63);
+        std::bitset<100> partial;
+        partial.set(1).set(64).set(99);
+        std::bitset<1000> large;
+        for (std::size_t i = 0; i < large.size(); i += 3) {
+            large.set(i);
+        }
+        const std::array<std::bitset<10>, 3> flags = { std::bitset<10>(0x3FF), std::bitset<10>(0), std::bitset<10>(0x155) };
+        OutByteStream obs = OutByteStream();
+        serialize(one, obs);
+        serialize(word, obs);
+        serialize(partial, obs);
+        serialize(large, obs);
+        serialize(std::bitset<0>(), obs);
+        serialize(flags, obs);
+        assert(obs.buffer().size() == 8 + 8 + 16 + 128 + 0 + 24);
+        InByteStream ibs = InByteStream(obs);
+        assert(deserialize<std::bitset<1>>(ibs) == one);
+        assert(deserialize<std::bitset<64>>(ibs) == word);
+        assert(deserialize<std::bitset<100>>(ibs) == partial);
+        skip<std::bitset<1000>>(ibs);
+        assert(deserialize<std::bitset<0>>(ibs).none());
+        assert((deserialize<std::array<std::bitset<10>, 3>>(ibs) == flags));
+        assert(ibs.isEmpty());
+    }
+    {
+        // Bits past the size in the last word are ignored
+        OutByteStream obs = OutByteStream();
+        serialize(std::size_t{ 3 }, obs);
+        serialize(~uint64_t{ 0 }, obs);
+        serialize(~uint64_t{ 0 }, obs);
+        serialize(std::vector<bool>(70, true), obs);
+        serialize(7, obs);
+        InByteStream ibs = InByteStream(obs);
+        assert(deserialize<std::vector<bool>>(ibs) == std::vector<bool>(3, true));
+        const std::bitset<5> bits = deserialize<std::bitset<5>>(ibs);
+        assert(bits.count() == 5 && bits.to_ullong() == 0x1F);
+        skip<std::vector<bool>>(ibs);
+        assert(deserialize<int>(ibs) == 7);
+        assert(ibs.isEmpty());
+    }
+    {
+        // The bit count cannot exceed the remaining input
+        OutByteStream obs = OutByteStream();
+        serialize(std::size_t{ 1'000'000 }, obs);
+        serialize(~uint64_t{ 0 }, obs);
+        InByteStream ibs = InByteStream(obs);
+        assert(deserialize<std::vector<bool>>(ibs).empty());
+        assert(ibs.error() == DecodeError::LengthExceedsInput);
+    }
+}
+
+// Serialized while compiling, stored in the binary
+constexpr auto EMBEDDED_TABLE = serializeToArray<[] {
+    std::vector<std::pair<int32_t, double>> table;
+    for (int32_t i = 0; i < 100; i++) {
+        table.push_back({ i, i * 0.5 });
+    }
+    return table;
+}>();
+constexpr auto EMBEDDED_VALUES = serializeToArray<[] {
+    return std::tuple<std::string, std::array<uint16_t, 3>, std::optional<float>, std::variant<int8_t, std::string>, std::vector<std::string>>(
+        "embedded", { 1, 2, 3 }, 2.5f, std::string("alternative"), { "a", "bc" });
+}>();
+// Bits are packed one at a time in constant evaluation
+using EmbeddedBits = std::tuple<std::vector<bool>, std::bitset<70>, std::array<std::bitset<5>, 2>>;
+constexpr auto EMBEDDED_BITS = serializeToArray<[] {
+    std::vector<bool> flags;
+    for (int i = 0; i < 100; i++) {
+        flags.push_back(i % 3 == 0);
+    }
+    return EmbeddedBits(flags, std::bitset<70>(0xF0F0F0F0F0F0F0F0ull), { std::bitset<5>(0b10101), std::bitset<5>(0b01010) });
+}>();
+static_assert(EMBEDDED_TABLE.size() == sizeof(std::size_t) + 100 * (sizeof(int32_t) + sizeof(double)));
+
+void testEmbedded_Deserialize() {
+    {
+        InByteStream ibs = InByteStream(std::span<const std::byte>(EMBEDDED_TABLE));
+        const auto table = deserialize<std::map<int32_t, double>>(ibs);
+        assert(table.size() == 100);
+        for (const auto& [key, value] : table) {
+            assert(value == key * 0.5);
+        }
+        assert(ibs.isEmpty());
+    }
+    {
+        using Values = std::tuple<std::string, std::array<uint16_t, 3>, std::optional<float>, std::variant<int8_t, std::string>, std::vector<std::string>>;
+        const Values expected = { "embedded", { 1, 2, 3 }, 2.5f, std::string("alternative"), { "a", "bc" } };
+        // The same overloads produce the same bytes at runtime
+        OutByteStream obs = OutByteStream();
+        serialize(expected, obs);
+        assert(obs.buffer().size() == EMBEDDED_VALUES.size());
+        assert(std::memcmp(obs.buffer().data(), EMBEDDED_VALUES.data(), EMBEDDED_VALUES.size()) == 0);
+        InByteStream ibs = InByteStream(std::span<const std::byte>(EMBEDDED_VALUES));
+        assert(deserialize<Values>(ibs) == expected);
+        assert(ibs.isEmpty());
+    }
+    {
+        std::vector<bool> flags;
+        for (int i = 0; i < 100; i++) {
+            flags.push_back(i % 3 == 0);
+        }
+        const EmbeddedBits expected = { flags, std::bitset<70>(0xF0F0F0F0F0F0F0F0ull), { std::bitset<5>(0b10101), std::bitset<5>(0b01010) } };
+        OutByteStream obs = OutByteStream();
+        serialize(expected, obs);
+        assert(obs.buffer().size() == EMBEDDED_BITS.size());
+        assert(std::memcmp(obs.buffer().data(), EMBEDDED_BITS.data(), EMBEDDED_BITS.size()) == 0);
+        InByteStream ibs = InByteStream(std::span<const std::byte>(EMBEDDED_BITS));
+        assert(deserialize<EmbeddedBits>(ibs) == expected);
+        assert(ibs.isEmpty());
+    }
+    {
+        // Reading past the end of the memory fails like any other input
+        InByteStream ibs = InByteStream(std::span<const std::byte>(EMBEDDED_TABLE.data(), 12));
+        assert((deserialize<std::map<int32_t, double>>(ibs).empty()));
+        assert(ibs.error() == DecodeError::LengthExceedsInput);
+    }
+    {
+        FixedOutByteStream<8> obs;
+        serialize(std::string("too long"), obs);
+        assert(obs.overflowed() && obs.position() == sizeof(std::size_t) + 8);
+    }
+}
+
+// Counts how many times it is actually encoded
+class TestCachedConfig {
+    uint64_t version;
+    std::string name;
+    std::vector<int> values;
+public:
+    static inline std::size_t encodeCount = 0;
+
+    explicit TestCachedConfig(uint64_t version, std::string name, std::vector<int> values) noexcept : version{ version }, name{ name }, values{ values } {}
+    // This is the deserialization constructor
+    explicit TestCachedConfig(InByteStream& ibs) {
+        version = deserialize<uint64_t>(ibs);
+        name = deserialize<std::string>(ibs);
+        values = deserialize<std::vector<int>>(ibs);
+    }
+    static void serialize(const TestCachedConfig& tc, OutByteStream& obs) {
+        encodeCount++;
+        ::serialize(tc.version, obs);
+        ::serialize(tc.name, obs);
+        ::serialize(tc.values, obs);
+    }
+    // The version identifies the content of an immutable config
+    static uint64_t cacheKey(const TestCachedConfig& tc) noexcept {
+        return tc.version;
+    }
+
+    bool operator==(const TestCachedConfig& rhs) const noexcept {
+        return (this->version == rhs.version) && (this->name == rhs.name) && (this->values == rhs.values);
+    }
+};
+
+class TestCachedNode {
+    std::shared_ptr<int> shared;
+public:
+    explicit TestCachedNode(std::shared_ptr<int> shared) noexcept : shared{ shared } {}
+    explicit TestCachedNode(InByteStream& ibs) {
+        shared = deserialize<std::shared_ptr<int>>(ibs);
+    }
+    static void serialize(const TestCachedNode& tc, OutByteStream& obs) {
+        ::serialize(tc.shared, obs);
+    }
+    static uint64_t cacheKey(const TestCachedNode&) noexcept {
+        return 1;
+    }
+    const std::shared_ptr<int>& value() const noexcept {
+        return shared;
+    }
+};
+
+void testSerializationCache() {
+    const TestCachedConfig config = TestCachedConfig(7, "config", std::vector<int>(100, 3));
+    OutByteStream uncached = OutByteStream();
+    serialize(config, uncached);
+    {
+        SerializationCache cache = SerializationCache(1024 * 1024);
+        TestCachedConfig::encodeCount = 0;
+        OutByteStream obs = OutByteStream();
+        obs.setCache(&cache);
+        for (int i = 0; i < 10; i++) {
+            serialize(config, obs);
+        }
+        assert(TestCachedConfig::encodeCount == 1);
+        const CacheStats stats = cache.stats();
+        assert(stats.hits == 9 && stats.misses == 1 && stats.entries == 1);
+        assert(stats.bytes == uncached.buffer().size());
+
+        // Other streams share the entries, the output is the same as without the cache
+        OutByteStream other = OutByteStream();
+        other.setCache(&cache);
+        serialize(std::vector<TestCachedConfig>{ config, config }, other);
+        assert(TestCachedConfig::encodeCount == 1);
+        InByteStream ibs = InByteStream(obs);
+        for (int i = 0; i < 10; i++) {
+            assert(deserialize<TestCachedConfig>(ibs) == config);
+        }
+        assert(ibs.isEmpty());
+        InByteStream otherIbs = InByteStream(other);
+        assert(deserialize<std::vector<TestCachedConfig>>(otherIbs).size() == 2);
+    }
+    {
+        // Least recently used entries are evicted past the memory cap
+        const std::size_t entrySize = uncached.buffer().size();
+        SerializationCache cache = SerializationCache(entrySize * 2);
+        OutByteStream obs = OutByteStream();
+        obs.setCache(&cache);
+        const TestCachedConfig first = TestCachedConfig(1, "config", std::vector<int>(100, 1));
+        const TestCachedConfig second = TestCachedConfig(2, "config", std::vector<int>(100, 2));
+        const TestCachedConfig third = TestCachedConfig(3, "config", std::vector<int>(100, 3));
+        serialize(first, obs);
+        serialize(second, obs);
+        serialize(first, obs);
+        serialize(third, obs);
+        CacheStats stats = cache.stats();
+        assert(stats.entries == 2 && stats.evictions == 1 && stats.bytes <= cache.maxBytes());
+        TestCachedConfig::encodeCount = 0;
+        serialize(first, obs);
+        assert(TestCachedConfig::encodeCount == 0);
+        serialize(second, obs);
+        assert(TestCachedConfig::encodeCount == 1);
+
+        // Values larger than the cap are never kept
+        cache.setMaxBytes(16);
+        assert(cache.stats().entries == 0);
+        serialize(first, obs);
+        assert(cache.stats().entries == 0);
+    }
+    {
+        // Shared object ids depend on the stream, values holding shared_ptrs are not cached
+        SerializationCache cache = SerializationCache(1024);
+        OutByteStream obs = OutByteStream();
+        obs.setCache(&cache);
+        const auto shared = std::make_shared<int>(5);
+        serialize(std::make_shared<int>(4), obs);
+        serialize(TestCachedNode(shared), obs);
+        serialize(TestCachedNode(shared), obs);
+        assert(cache.stats().entries == 0);
+        InByteStream ibs = InByteStream(obs);
+        assert(*deserialize<std::shared_ptr<int>>(ibs) == 4);
+        const auto a = deserialize<TestCachedNode>(ibs);
+        const auto b = deserialize<TestCachedNode>(ibs);
+        assert(*a.value() == 5 && a.value() == b.value());
+        assert(ibs.isEmpty());
+    }
+}
+
 void runTests() {
     testIntegral_Serialize_Deserialize();
     testFloat_Serialize_Deserialize();
@@ -711,4 +1778,30 @@ void runTests() {
     testLarge_Serialization_Deserialization();
 
     testClass_Serialize_Deserialize();
+
+    testPointer_Serialize_Deserialize();
+
+    testFixedComposite_Serialize_Deserialize();
+
+    testSequenceWriter();
+
+    testDelta();
+
+    testReadAhead();
+
+    testXorCompression();
+
+    testPackedBool_Serialize_Deserialize();
+
+    testEmbedded_Deserialize();
+
+    testSerializationCache();
+
+    testSkip();
+
+    testStreamStats();
+
+    testDecodeLimits();
+
+    testSharedOutByteStream();
 }
\ No newline at end of file
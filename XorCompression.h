@@ -0,0 +1,195 @@
+#ifndef __HEADER_XORCOMPRESSION_H_
+#define __HEADER_XORCOMPRESSION_H_
+
+#include "ByteStreams.h"
+#include "Serialize.h"
+#include "Deserialize.h"
+
+#include <bit>
+
+// Opt-in Gorilla style compression for std::vector<float> and std::vector<double>.
+// Each value is XORed with the previous one: an unchanged value takes 1 bit, otherwise only the meaningful
+// bits between the leading and trailing zeros of the XOR are written. Values are compared as raw bits,
+// so the roundtrip is bit exact including NaN payloads and -0.0.
+//
+// Format: element count, byte length of the bit stream (so it can be skipped with a single seek), bit stream.
+
+template<typename T> concept XorCompressible = std::same_as<T, std::vector<float>> || std::same_as<T, std::vector<double>>;
+
+// Unsigned integer with the same bits as the floating point type
+template<typename F> using XorBits = std::conditional_t<sizeof(F) == sizeof(uint32_t), uint32_t, uint64_t>;
+
+// Most significant bit first
+class BitWriter {
+    std::vector<uint8_t>& out;
+    uint64_t accumulator = 0;
+    unsigned pending = 0; // Bits in the accumulator not yet written out, always less than 8 between calls
+public:
+    explicit BitWriter(std::vector<uint8_t>& out) noexcept : out{ out } {}
+    void write(uint64_t value, unsigned bits) {
+        if (bits > 32) {
+            write(value >> 32, bits - 32);
+            bits = 32;
+        }
+        const uint64_t mask = (uint64_t{ 1 } << bits) - 1;
+        accumulator = (accumulator << bits) | (value & mask);
+        pending += bits;
+        while (pending >= BITS_PER_BYTE) {
+            pending -= BITS_PER_BYTE;
+            out.push_back(static_cast<uint8_t>(accumulator >> pending));
+        }
+    }
+    void finish() {
+        if (pending > 0) {
+            out.push_back(static_cast<uint8_t>(accumulator << (BITS_PER_BYTE - pending)));
+            pending = 0;
+        }
+    }
+};
+
+// Reads a bit stream that is followed by enough zero bytes for every read to be one unaligned 8 byte load
+class BitReader {
+    const uint8_t* data;
+    std::size_t position = 0; // In bits
+public:
+    explicit BitReader(const uint8_t* data) noexcept : data{ data } {}
+    // At most 32 bits at a time
+    uint64_t read(unsigned bits) noexcept {
+        uint64_t window = 0;
+        for (std::size_t i = 0; i < sizeof(uint64_t); i++) {
+            window = (window << BITS_PER_BYTE) | data[(position >> 3) + i];
+        }
+        const uint64_t value = bits == 0 ? 0 : (window << (position & 7)) >> (64 - bits);
+        position += bits;
+        return value;
+    }
+    uint64_t readWide(unsigned bits) noexcept {
+        if (bits > 32) {
+            const uint64_t high = read(bits - 32);
+            return (high << 32) | read(32);
+        }
+        return read(bits);
+    }
+    std::size_t bitsRead() const noexcept {
+        return position;
+    }
+};
+
+template<typename T> requires XorCompressible<T> void serializeXor(const T& data, OutByteStream& obs) noexcept {
+    using F = typename T::value_type;
+    using U = XorBits<F>;
+    constexpr unsigned BITS = sizeof(U) * BITS_PER_BYTE;
+    // Bits needed to store a leading zero count or a meaningful bit length (stored minus one)
+    constexpr unsigned WINDOW_BITS = std::bit_width(BITS - 1);
+
+    std::vector<uint8_t> encoded;
+    encoded.reserve(data.size() * sizeof(F) / 4 + 16);
+    BitWriter writer = BitWriter(encoded);
+    U previous = 0;
+    unsigned previousLeading = BITS;
+    unsigned previousTrailing = 0;
+    for (std::size_t i = 0; i < data.size(); i++) {
+        const U current = std::bit_cast<U>(data[i]);
+        if (i == 0) {
+            writer.write(current, BITS);
+            previous = current;
+            continue;
+        }
+        const U difference = current ^ previous;
+        previous = current;
+        if (difference == 0) {
+            writer.write(0, 1);
+            continue;
+        }
+        const unsigned leading = static_cast<unsigned>(std::countl_zero(difference));
+        const unsigned trailing = static_cast<unsigned>(std::countr_zero(difference));
+        if (previousLeading != BITS && leading >= previousLeading && trailing >= previousTrailing) {
+            // Fits in the window of the previous value
+            const unsigned length = BITS - previousLeading - previousTrailing;
+            writer.write(0b10, 2);
+            writer.write(difference >> previousTrailing, length);
+        }
+        else {
+            const unsigned length = BITS - leading - trailing;
+            writer.write(0b11, 2);
+            writer.write(leading, WINDOW_BITS);
+            writer.write(length - 1, WINDOW_BITS);
+            writer.write(difference >> trailing, length);
+            previousLeading = leading;
+            previousTrailing = trailing;
+        }
+    }
+    writer.finish();
+
+    serialize(data.size(), obs);
+    serialize(encoded.size(), obs);
+    obs.pushBytes(encoded.data(), encoded.size());
+}
+
+template<typename T> requires XorCompressible<T> T deserializeXor(InByteStream& ibs) {
+    using F = typename T::value_type;
+    using U = XorBits<F>;
+    constexpr unsigned BITS = sizeof(U) * BITS_PER_BYTE;
+    constexpr unsigned WINDOW_BITS = std::bit_width(BITS - 1);
+    // Most bits one value can take, the decoder checks the position between values so a corrupt
+    // stream can run this far past its end before it is caught
+    constexpr std::size_t MAX_VALUE_BITS = 2 + 2 * WINDOW_BITS + BITS;
+    constexpr std::size_t PADDING = (MAX_VALUE_BITS + BITS_PER_BYTE - 1) / BITS_PER_BYTE + sizeof(uint64_t);
+
+    T retval = {};
+    const std::size_t size = deserialize<std::size_t>(ibs);
+    const std::size_t encodedSize = deserialize<std::size_t>(ibs);
+    if (!ibs.acceptLength(size, 0) || !ibs.acceptLength(encodedSize, 1)) {
+        return retval;
+    }
+    // The first value takes BITS bits and every value after it at least one bit
+    const std::size_t encodedBits = encodedSize * BITS_PER_BYTE;
+    if (size != 0 && (encodedBits < BITS || size - 1 > encodedBits - BITS)) {
+        ibs.fail(DecodeError::InvalidCompressedData);
+        return retval;
+    }
+    std::vector<uint8_t> encoded(encodedSize + PADDING, 0);
+    ibs.readBytes(encoded.data(), encodedSize);
+
+    retval.resize(size);
+    BitReader reader = BitReader(encoded.data());
+    U previous = 0;
+    unsigned leading = 0;
+    unsigned trailing = 0;
+    for (std::size_t i = 0; i < size; i++) {
+        if (i == 0) {
+            previous = static_cast<U>(reader.readWide(BITS));
+        }
+        else if (reader.read(1) == 1) {
+            if (reader.read(1) == 1) {
+                leading = static_cast<unsigned>(reader.read(WINDOW_BITS));
+                const unsigned length = static_cast<unsigned>(reader.read(WINDOW_BITS)) + 1;
+                if (leading + length > BITS) {
+                    ibs.fail(DecodeError::InvalidCompressedData);
+                    retval.clear();
+                    return retval;
+                }
+                trailing = BITS - leading - length;
+            }
+            const unsigned length = BITS - leading - trailing;
+            previous ^= static_cast<U>(reader.readWide(length) << trailing);
+        }
+        retval[i] = std::bit_cast<F>(previous);
+        if ((reader.bitsRead() + BITS_PER_BYTE - 1) / BITS_PER_BYTE > encodedSize) {
+            ibs.fail(DecodeError::InvalidCompressedData);
+            retval.clear();
+            return retval;
+        }
+    }
+    return retval;
+}
+
+template<typename T> requires XorCompressible<T> void skipXor(InByteStream& ibs) {
+    deserialize<std::size_t>(ibs);
+    const std::size_t encodedSize = deserialize<std::size_t>(ibs);
+    if (ibs.acceptLength(encodedSize, 1)) {
+        ibs.skipBytes(encodedSize);
+    }
+}
+
+#endif // !__HEADER_XORCOMPRESSION_H_